@@ -0,0 +1,392 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <unistd.h>
+
+#include "units.h"
+#include "cord.h"
+#include "rectangle.h"
+#include "tile.h"
+#include "line.h"
+#include "lineTile.h"
+#include "cornerStitching.h"
+#include "frozenPlane.h"
+
+// Microbenchmarks of the CornerStitching primitives on synthetic planes.
+// usage: csbench [-m maxTileCount] [-s seed]
+// Results go to stdout as one JSON document, progress goes to stderr
+
+// every global allocation is counted, so each primitive also reports its allocations per operation
+static std::atomic<size_t> allocationCount(0);
+
+void *operator new(size_t size){
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    void *memory = std::malloc((size == 0)? 1 : size);
+    if(memory == nullptr) throw std::bad_alloc();
+    return memory;
+}
+
+void operator delete(void *memory) noexcept{
+    std::free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept{
+    std::free(memory);
+}
+
+enum class planePattern{
+    RANDOM, CLUSTERED, STRIPE
+};
+
+static const char *patternName(planePattern pattern){
+    switch (pattern){
+    case planePattern::RANDOM:
+        return "random";
+    case planePattern::CLUSTERED:
+        return "clustered";
+    default:
+        return "stripe";
+    }
+}
+
+// the canvas is a grid of cells, every chosen cell receives one tile
+static const len_t CELL_WIDTH = 64;
+static const len_t CELL_HEIGHT = 64;
+static const len_t STRIPE_CELL_WIDTH = 8;
+static const len_t STRIPE_CELL_HEIGHT = 256;
+
+struct SyntheticPlane{
+    len_t width;
+    len_t height;
+    std::vector<Tile> prototypes;
+};
+
+// RANDOM: random sized tiles in randomly chosen cells (half of the cells are used)
+// CLUSTERED: cells closest to a few cluster centres, tiles nearly fill their cells
+// STRIPE: thin full-height columns, every tile cuts the blank strips of its rows
+static SyntheticPlane buildSyntheticPlane(planePattern pattern, int tileCount, std::mt19937 &rng){
+    SyntheticPlane plane;
+    len_t cellWidth = (pattern == planePattern::STRIPE)? STRIPE_CELL_WIDTH : CELL_WIDTH;
+    len_t cellHeight = (pattern == planePattern::STRIPE)? STRIPE_CELL_HEIGHT : CELL_HEIGHT;
+    int gridSide = int(std::ceil(std::sqrt(2.0 * tileCount)));
+    plane.width = gridSide * cellWidth;
+    plane.height = gridSide * cellHeight;
+
+    std::vector<int> cells(gridSide * gridSide);
+    for(int i = 0; i < int(cells.size()); ++i) cells[i] = i;
+
+    if(pattern == planePattern::RANDOM){
+        std::shuffle(cells.begin(), cells.end(), rng);
+    }else if(pattern == planePattern::CLUSTERED){
+        std::vector<std::pair<double, double>> centres;
+        for(int i = 0; i < 8; ++i){
+            centres.push_back(std::make_pair(double(rng() % gridSide), double(rng() % gridSide)));
+        }
+        std::vector<double> distance(cells.size());
+        for(int i = 0; i < int(cells.size()); ++i){
+            double x = i % gridSide, y = i / gridSide;
+            double best = 1e18;
+            for(std::pair<double, double> const &centre : centres){
+                best = std::min(best, std::hypot(x - centre.first, y - centre.second));
+            }
+            distance[i] = best + double(rng() % 1000) / 500.0;
+        }
+        std::sort(cells.begin(), cells.end(), [&](int a, int b){ return distance[a] < distance[b]; });
+    }
+    cells.resize(tileCount);
+
+    plane.prototypes.reserve(tileCount);
+    for(int const &cell : cells){
+        len_t cellX = (cell % gridSide) * cellWidth;
+        len_t cellY = (cell / gridSide) * cellHeight;
+        Rectangle tileRect;
+        if(pattern == planePattern::RANDOM){
+            len_t w = 4 + rng() % (cellWidth - 8), h = 4 + rng() % (cellHeight - 8);
+            len_t x = cellX + 2 + rng() % (cellWidth - w - 3), y = cellY + 2 + rng() % (cellHeight - h - 3);
+            tileRect = Rectangle(x, y, x + w, y + h);
+        }else if(pattern == planePattern::CLUSTERED){
+            tileRect = Rectangle(cellX + 1, cellY + 1, cellX + cellWidth - 1, cellY + cellHeight - 1);
+        }else{
+            tileRect = Rectangle(cellX + 2, cellY, cellX + cellWidth - 2, cellY + cellHeight);
+        }
+        plane.prototypes.push_back(Tile(tileType::BLOCK, tileRect));
+    }
+    return plane;
+}
+
+// latency samples (ns) and allocation count of one primitive
+struct Measurement{
+    std::string primitive;
+    std::vector<double> latencies;
+    double totalNs = 0.0;
+    size_t allocations = 0;
+};
+
+// every primitive stops after maxOps operations or once it has spent TIME_BUDGET_NS (but runs at least MIN_OPS operations),
+// so the million-tile planes finish in reasonable time
+static const double TIME_BUDGET_NS = 2e9;
+static const int MIN_OPS = 100;
+
+static bool keepMeasuring(const Measurement &measurement, int maxOps, int minOps = MIN_OPS){
+    int done = measurement.latencies.size();
+    if(done >= maxOps) return false;
+    return (done < minOps) || (measurement.totalNs < TIME_BUDGET_NS);
+}
+
+template <typename Operation>
+static void measure(Measurement &measurement, Operation &&operation){
+    size_t allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    operation();
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double, std::nano>(end - start).count();
+    measurement.latencies.push_back(elapsed);
+    measurement.totalNs += elapsed;
+    measurement.allocations += allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+}
+
+static double percentile(const std::vector<double> &sorted, double fraction){
+    if(sorted.empty()) return 0.0;
+    size_t idx = std::min(sorted.size() - 1, size_t(fraction * (sorted.size() - 1) + 0.5));
+    return sorted[idx];
+}
+
+static std::string toJSON(planePattern pattern, int tileCount, const Measurement &measurement){
+    std::vector<double> sorted(measurement.latencies);
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0.0;
+    for(double const &ns : sorted) total += ns;
+    double ops = std::max<double>(1.0, sorted.size());
+
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1);
+    oss << "{\"pattern\": \"" << patternName(pattern) << "\", \"tiles\": " << tileCount << ", \"primitive\": \"" << measurement.primitive << "\""
+        << ", \"ops\": " << sorted.size() << ", \"ns_per_op\": " << total / ops
+        << ", \"p50_ns\": " << percentile(sorted, 0.50) << ", \"p90_ns\": " << percentile(sorted, 0.90)
+        << ", \"p99_ns\": " << percentile(sorted, 0.99) << ", \"max_ns\": " << (sorted.empty()? 0.0 : sorted.back())
+        << std::setprecision(3) << ", \"allocs_per_op\": " << double(measurement.allocations) / ops << "}";
+    return oss.str();
+}
+
+// run every primitive on one synthetic plane, append the JSON records to results
+static void benchmarkPlane(planePattern pattern, int tileCount, std::mt19937 &rng, std::vector<std::string> &results){
+    std::cerr << "[csbench] " << patternName(pattern) << " plane, " << tileCount << " tiles" << std::endl;
+
+    SyntheticPlane synthetic = buildSyntheticPlane(pattern, tileCount, rng);
+    CornerStitching cs(synthetic.width, synthetic.height);
+    std::vector<Tile *> tiles;
+    cs.bulkLoad(synthetic.prototypes, tiles);
+    // point finding is measured the way large planes are meant to be used: with a seed grid of about one cell per tile
+    int seedGridSide = std::max(1, int(std::sqrt(double(tileCount))));
+    cs.enableSeedGrid(seedGridSide, seedGridSide);
+    // the grid fills lazily, warm every cell (untimed) so the measurements see the steady state
+    len_t seedCellWidth = (synthetic.width + seedGridSide - 1) / seedGridSide, seedCellHeight = (synthetic.height + seedGridSide - 1) / seedGridSide;
+    for(len_t y = seedCellHeight / 2; y < synthetic.height; y += seedCellHeight){
+        for(len_t x = seedCellWidth / 2; x < synthetic.width; x += seedCellWidth){
+            cs.findPoint(Cord(x, y));
+        }
+    }
+
+    // smaller planes get more repetitions, so each primitive runs at least a few milliseconds
+    int queryOps = 20000;
+    int editOps = std::min(tileCount, 5000);
+    int copyOps = std::max(3, std::min(50, 200000 / tileCount));
+
+    auto randomCord = [&](){
+        return Cord(rng() % synthetic.width, rng() % synthetic.height);
+    };
+    auto randomTileIdx = [&](){
+        return int(rng() % tiles.size());
+    };
+
+    Measurement findPointM{"findPoint"};
+    while(keepMeasuring(findPointM, queryOps)){
+        Cord key = randomCord();
+        Tile *found = nullptr;
+        measure(findPointM, [&](){ found = cs.findPoint(key); });
+        if(found == nullptr) std::abort();
+    }
+    results.push_back(toJSON(pattern, tileCount, findPointM));
+
+    // one op is a whole batch of random queries, compare its ns_per_op with POINT_BATCH findPoint ops
+    static const int POINT_BATCH = 1024;
+    Measurement findPointsM{"findPoints(" + std::to_string(POINT_BATCH) + ")"};
+    std::vector<Cord> batchKeys(POINT_BATCH);
+    std::vector<Tile *> batchAnswers;
+    while(keepMeasuring(findPointsM, queryOps / POINT_BATCH, 10)){
+        for(Cord &key : batchKeys) key = randomCord();
+        measure(findPointsM, [&](){ cs.findPoints(batchKeys, batchAnswers); });
+        for(int i = 0; i < POINT_BATCH; ++i){
+            if(batchAnswers[i] != cs.findPoint(batchKeys[i])) std::abort();
+        }
+    }
+    results.push_back(toJSON(pattern, tileCount, findPointsM));
+
+    Measurement enumerateM{"enumerateDirectedArea"};
+    std::vector<Tile *> enumerated;
+    while(keepMeasuring(enumerateM, queryOps / 10)){
+        len_t boxWidth = std::min(synthetic.width, 4 * CELL_WIDTH), boxHeight = std::min(synthetic.height, 4 * CELL_HEIGHT);
+        len_t x = rng() % (synthetic.width - boxWidth + 1), y = rng() % (synthetic.height - boxHeight + 1);
+        Rectangle box(x, y, x + boxWidth, y + boxHeight);
+        enumerated.clear();
+        measure(enumerateM, [&](){ cs.enumerateDirectedArea(box, enumerated); });
+    }
+    results.push_back(toJSON(pattern, tileCount, enumerateM));
+
+    Measurement findLineTileM{"findLineTile"};
+    std::vector<LineTile> positiveSide, negativeSide;
+    while(keepMeasuring(findLineTileM, queryOps / 10)){
+        Line line;
+        if(findLineTileM.latencies.size() % 2 == 0){
+            len_t length = std::min(synthetic.width, 4 * CELL_WIDTH);
+            len_t x = rng() % (synthetic.width - length + 1), y = 1 + rng() % (synthetic.height - 1);
+            line = Line(Cord(x, y), Cord(x + length, y));
+        }else{
+            len_t length = std::min(synthetic.height, 4 * CELL_HEIGHT);
+            len_t x = 1 + rng() % (synthetic.width - 1), y = rng() % (synthetic.height - length + 1);
+            line = Line(Cord(x, y), Cord(x, y + length));
+        }
+        positiveSide.clear();
+        negativeSide.clear();
+        measure(findLineTileM, [&](){ cs.findLineTile(line, positiveSide, negativeSide); });
+    }
+    results.push_back(toJSON(pattern, tileCount, findLineTileM));
+
+    // the read-only copy: building it, then the point & area queries above answered by it
+    Measurement freezeM{"freeze"};
+    std::unique_ptr<FrozenPlane> frozen;
+    while(keepMeasuring(freezeM, copyOps, 1)){
+        measure(freezeM, [&](){ frozen.reset(new FrozenPlane(cs)); });
+    }
+    results.push_back(toJSON(pattern, tileCount, freezeM));
+
+    Measurement frozenFindPointM{"frozenFindPoint"};
+    while(keepMeasuring(frozenFindPointM, queryOps)){
+        Cord key = randomCord();
+        int found = -1;
+        measure(frozenFindPointM, [&](){ found = frozen->findPoint(key); });
+        if(frozen->getSourceTile(found) != cs.findPoint(key)) std::abort();
+    }
+    results.push_back(toJSON(pattern, tileCount, frozenFindPointM));
+
+    Measurement frozenEnumerateM{"frozenEnumerateArea"};
+    std::vector<int> frozenEnumerated;
+    while(keepMeasuring(frozenEnumerateM, queryOps / 10)){
+        len_t boxWidth = std::min(synthetic.width, 4 * CELL_WIDTH), boxHeight = std::min(synthetic.height, 4 * CELL_HEIGHT);
+        len_t x = rng() % (synthetic.width - boxWidth + 1), y = rng() % (synthetic.height - boxHeight + 1);
+        Rectangle box(x, y, x + boxWidth, y + boxHeight);
+        frozenEnumerated.clear();
+        measure(frozenEnumerateM, [&](){ frozen->enumerateArea(box, frozenEnumerated); });
+    }
+    results.push_back(toJSON(pattern, tileCount, frozenEnumerateM));
+    frozen.reset();
+
+    Measurement removeM{"removeTile"}, insertM{"insertTile"};
+    while(keepMeasuring(removeM, editOps) && keepMeasuring(insertM, editOps)){
+        int idx = randomTileIdx();
+        Tile prototype(tileType::BLOCK, tiles[idx]->getRectangle());
+        measure(removeM, [&](){ cs.removeTile(tiles[idx]); });
+        measure(insertM, [&](){ tiles[idx] = cs.insertTile(prototype); });
+    }
+    results.push_back(toJSON(pattern, tileCount, removeM));
+    results.push_back(toJSON(pattern, tileCount, insertM));
+
+    Measurement cutHM{"cutTileHorizontally"}, mergeVM{"mergeTilesVertically"};
+    Measurement cutVM{"cutTileVertically"}, mergeHM{"mergeTilesHorizontally"};
+    for(int i = 0; i < editOps && (keepMeasuring(cutHM, editOps) || keepMeasuring(cutVM, editOps)); ++i){
+        int idx = randomTileIdx();
+        Tile *victim = tiles[idx];
+        Tile *piece = nullptr;
+        if(victim->getHeight() >= 2){
+            measure(cutHM, [&](){ piece = cs.cutTileHorizontally(victim, victim->getHeight() / 2); });
+            measure(mergeVM, [&](){ tiles[idx] = cs.mergeTilesVertically(victim, piece); });
+        }
+        victim = tiles[idx];
+        if(victim->getWidth() >= 2){
+            measure(cutVM, [&](){ piece = cs.cutTileVertically(victim, victim->getWidth() / 2); });
+            measure(mergeHM, [&](){ tiles[idx] = cs.mergeTilesHorizontally(piece, victim); });
+        }
+    }
+    results.push_back(toJSON(pattern, tileCount, cutHM));
+    results.push_back(toJSON(pattern, tileCount, mergeVM));
+    results.push_back(toJSON(pattern, tileCount, cutVM));
+    results.push_back(toJSON(pattern, tileCount, mergeHM));
+
+    Measurement generalSplitM{"generalSplitTile"};
+    std::vector<Tile *> newNeighbors;
+    for(int i = 0; i < editOps && keepMeasuring(generalSplitM, editOps); ++i){
+        int idx = randomTileIdx();
+        Tile *victim = tiles[idx];
+        if((victim->getWidth() < 3) || (victim->getHeight() < 3)) continue;
+        Rectangle original = victim->getRectangle();
+        len_t thirdWidth = victim->getWidth() / 3, thirdHeight = victim->getHeight() / 3;
+        Rectangle centre(rec::getXL(original) + thirdWidth, rec::getYL(original) + thirdHeight,
+                         rec::getXH(original) - thirdWidth, rec::getYH(original) - thirdHeight);
+        newNeighbors.clear();
+        Tile *centreTile = nullptr;
+        measure(generalSplitM, [&](){ centreTile = cs.generalSplitTile(victim, centre, newNeighbors); });
+
+        // put the original tile back
+        cs.beginBatch();
+        for(Tile *const &neighbor : newNeighbors){
+            cs.removeTile(neighbor);
+        }
+        cs.removeTile(centreTile);
+        tiles[idx] = cs.insertTile(Tile(tileType::BLOCK, original));
+        cs.endBatch();
+    }
+    results.push_back(toJSON(pattern, tileCount, generalSplitM));
+
+    Measurement copyM{"copyConstructor"};
+    while(keepMeasuring(copyM, copyOps, 1)){
+        std::unique_ptr<CornerStitching> copy;
+        measure(copyM, [&](){ copy.reset(new CornerStitching(cs)); });
+    }
+    results.push_back(toJSON(pattern, tileCount, copyM));
+}
+
+int main(int argc, char *argv[]){
+    int maxTileCount = 1000000;
+    unsigned int seed = 1;
+
+    int opt;
+    while((opt = getopt(argc, argv, "m:s:")) != -1){
+        switch (opt){
+        case 'm':
+            maxTileCount = std::atoi(optarg);
+            break;
+        case 's':
+            seed = (unsigned int)std::atoi(optarg);
+            break;
+        default:
+            std::cerr << "usage: " << argv[0] << " [-m maxTileCount] [-s seed]" << std::endl;
+            return 4;
+        }
+    }
+
+    std::mt19937 rng(seed);
+    std::vector<std::string> results;
+    for(int tileCount = 1000; tileCount <= maxTileCount; tileCount *= 10){
+        for(planePattern pattern : {planePattern::RANDOM, planePattern::CLUSTERED, planePattern::STRIPE}){
+            benchmarkPlane(pattern, tileCount, rng, results);
+        }
+    }
+
+    std::cout << "{\"benchmark\": \"cornerStitching\", \"seed\": " << seed << ", \"results\": [" << std::endl;
+    for(size_t i = 0; i < results.size(); ++i){
+        std::cout << "  " << results[i] << ((i + 1 < results.size())? "," : "") << std::endl;
+    }
+    std::cout << "]}" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,217 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <unistd.h>
+
+#include "units.h"
+#include "cord.h"
+#include "rectangle.h"
+#include "tile.h"
+#include "line.h"
+#include "lineTile.h"
+#include "cornerStitching.h"
+
+// Concurrent-reader stress test of CornerStitching, meant to be built with -fsanitize=thread (make stress).
+// Several threads query one plane at the same time (findPoint with a cold seed grid, enumerateDirectedArea, visitDirectedArea,
+// searchArea, neighbour walks, findLineTile, blank area queries) and compare every answer with the one computed beforehand on a
+// single-threaded copy of the plane.
+// usage: csstress [-t threadCount] [-n tileCount] [-q queryCount] [-s seed]
+// Prints "ok" and returns 0 if every answer matches (ThreadSanitizer reports races on stderr and fails the run on its own)
+
+static const len_t CELL_WIDTH = 64;
+static const len_t CELL_HEIGHT = 64;
+
+enum class queryKind{
+    FIND_POINT, ENUMERATE_AREA, VISIT_AREA, SEARCH_AREA, NEIGHBORS, LINE_TILE, BLANK_AREA
+};
+static const int QUERY_KIND_COUNT = 7;
+
+struct Query{
+    queryKind kind;
+    Cord point;
+    Rectangle box;
+    Line line;
+};
+
+// every answer is flattened into plain coordinates, so answers from different planes can be compared
+typedef std::vector<long long> Answer;
+
+static void appendRectangle(Answer &answer, const Rectangle &rect){
+    answer.push_back(rec::getXL(rect));
+    answer.push_back(rec::getYL(rect));
+    answer.push_back(rec::getXH(rect));
+    answer.push_back(rec::getYH(rect));
+}
+
+static void appendTile(Answer &answer, Tile *tile){
+    answer.push_back(int(tile->getType()));
+    appendRectangle(answer, tile->getRectangle());
+}
+
+static Answer runQuery(const CornerStitching &cs, const Query &query){
+    Answer answer;
+    switch (query.kind){
+    case queryKind::FIND_POINT:{
+        appendTile(answer, cs.findPoint(query.point));
+        break;
+    }
+    case queryKind::ENUMERATE_AREA:{
+        std::vector<Tile *> tiles;
+        cs.enumerateDirectedArea(query.box, tiles);
+        for(Tile *const &tile : tiles) appendTile(answer, tile);
+        break;
+    }
+    case queryKind::VISIT_AREA:{
+        // stop after the fifth tile, exercises the early exit
+        int visited = 0;
+        cs.visitDirectedArea(query.box, [&](Tile *tile){
+            appendTile(answer, tile);
+            return (++visited < 5);
+        });
+        break;
+    }
+    case queryKind::SEARCH_AREA:{
+        answer.push_back(cs.searchArea(query.box));
+        break;
+    }
+    case queryKind::NEIGHBORS:{
+        Tile *centre = cs.findPoint(query.point);
+        std::vector<Tile *> neighbors;
+        cs.findAllNeighbors(centre, neighbors);
+        for(Tile *const &neighbor : neighbors) appendTile(answer, neighbor);
+        for(Tile *const &neighbor : cs.neighbors(centre, direction2D::UP)) appendTile(answer, neighbor);
+        break;
+    }
+    case queryKind::LINE_TILE:{
+        std::vector<LineTile> positiveSide, negativeSide;
+        cs.findLineTile(query.line, positiveSide, negativeSide);
+        for(LineTile const &lineTile : positiveSide){
+            appendTile(answer, lineTile.getTile());
+        }
+        answer.push_back(-1);
+        for(LineTile const &lineTile : negativeSide){
+            appendTile(answer, lineTile.getTile());
+        }
+        break;
+    }
+    case queryKind::BLANK_AREA:{
+        answer.push_back(cs.calculateBlankArea(query.box));
+        break;
+    }
+    }
+    return answer;
+}
+
+int main(int argc, char *argv[]){
+    int threadCount = 8;
+    int tileCount = 2000;
+    int queryCount = 4000;
+    unsigned int seed = 1;
+
+    int opt;
+    while((opt = getopt(argc, argv, "t:n:q:s:")) != -1){
+        switch (opt){
+        case 't':
+            threadCount = std::max(1, std::atoi(optarg));
+            break;
+        case 'n':
+            tileCount = std::max(1, std::atoi(optarg));
+            break;
+        case 'q':
+            queryCount = std::max(1, std::atoi(optarg));
+            break;
+        case 's':
+            seed = (unsigned int)std::atoi(optarg);
+            break;
+        default:
+            std::cerr << "usage: " << argv[0] << " [-t threadCount] [-n tileCount] [-q queryCount] [-s seed]" << std::endl;
+            return 4;
+        }
+    }
+
+    std::mt19937 rng(seed);
+
+    // random sized tiles in half of the cells of a square grid
+    int gridSide = int(std::ceil(std::sqrt(2.0 * tileCount)));
+    len_t width = gridSide * CELL_WIDTH;
+    len_t height = gridSide * CELL_HEIGHT;
+    std::vector<int> cells(gridSide * gridSide);
+    for(int i = 0; i < int(cells.size()); ++i) cells[i] = i;
+    std::shuffle(cells.begin(), cells.end(), rng);
+    cells.resize(tileCount);
+
+    std::vector<Tile> prototypes;
+    for(int const &cell : cells){
+        len_t cellX = (cell % gridSide) * CELL_WIDTH;
+        len_t cellY = (cell / gridSide) * CELL_HEIGHT;
+        len_t w = 4 + rng() % (CELL_WIDTH - 8), h = 4 + rng() % (CELL_HEIGHT - 8);
+        len_t x = cellX + 2 + rng() % (CELL_WIDTH - w - 3), y = cellY + 2 + rng() % (CELL_HEIGHT - h - 3);
+        prototypes.push_back(Tile(tileType::BLOCK, Rectangle(x, y, x + w, y + h)));
+    }
+
+    CornerStitching cs(width, height);
+    std::vector<Tile *> tiles;
+    cs.bulkLoad(prototypes, tiles);
+
+    std::vector<Query> queries(queryCount);
+    for(int i = 0; i < queryCount; ++i){
+        Query &query = queries[i];
+        query.kind = queryKind(rng() % QUERY_KIND_COUNT);
+        query.point = Cord(rng() % width, rng() % height);
+        len_t boxWidth = std::min(width, 1 + len_t(rng() % (4 * CELL_WIDTH))), boxHeight = std::min(height, 1 + len_t(rng() % (4 * CELL_HEIGHT)));
+        len_t x = rng() % (width - boxWidth + 1), y = rng() % (height - boxHeight + 1);
+        query.box = Rectangle(x, y, x + boxWidth, y + boxHeight);
+        if(rng() % 2 == 0){
+            len_t lineY = 1 + rng() % (height - 1);
+            query.line = Line(Cord(x, lineY), Cord(x + boxWidth, lineY));
+        }else{
+            len_t lineX = 1 + rng() % (width - 1);
+            query.line = Line(Cord(lineX, y), Cord(lineX, y + boxHeight));
+        }
+    }
+
+    // reference answers come from a copy queried by this thread only
+    std::vector<Answer> expected(queryCount);
+    {
+        CornerStitching reference(cs);
+        for(int i = 0; i < queryCount; ++i){
+            expected[i] = runQuery(reference, queries[i]);
+        }
+    }
+
+    // the seed grid starts cold, so the readers also race on filling its cells
+    int seedGridSide = std::max(1, int(std::sqrt(double(tileCount))));
+    cs.enableSeedGrid(seedGridSide, seedGridSide);
+
+    std::atomic<int> mismatchCount(0);
+    std::vector<std::thread> readers;
+    for(int t = 0; t < threadCount; ++t){
+        readers.emplace_back([&, t](){
+            // each reader walks the queries in its own order
+            std::vector<int> order(queryCount);
+            for(int i = 0; i < queryCount; ++i) order[i] = i;
+            std::shuffle(order.begin(), order.end(), std::mt19937(seed + 1 + t));
+            for(int const &i : order){
+                if(runQuery(cs, queries[i]) != expected[i]){
+                    mismatchCount.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+    for(std::thread &reader : readers){
+        reader.join();
+    }
+
+    if(mismatchCount.load() != 0){
+        std::cout << "FAIL " << mismatchCount.load() << " mismatching answers (" << threadCount << " threads, " << queryCount << " queries)" << std::endl;
+        return 1;
+    }
+    std::cout << "ok " << threadCount << " threads, " << tileCount << " tiles, " << queryCount << " queries each" << std::endl;
+    return 0;
+}
@@ -0,0 +1,469 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <tuple>
+#include <algorithm>
+
+#include "units.h"
+#include "rectangle.h"
+#include "tile.h"
+#include "cornerStitching.h"
+#include "doughnutPolygonSet.h"
+#include "globalResult.h"
+#include "rectilinear.h"
+#include "floorplan.h"
+#include "frozenPlane.h"
+#include "cSException.h"
+
+// Edit checks of Floorplan (make check). Each check builds a small floorplan, edits it through the public primitives and compares
+// the result with what the edits must leave behind (compaction, transaction rollback, frozen copies).
+// usage: fpcheck
+// Prints "ok" and returns 0 if every check passes, otherwise prints the first failing check and returns 1
+
+// type, geometry & payload ids of one tile, a sorted vector of them describes the tiles of a plane independently of tile addresses
+typedef std::tuple<int, len_t, len_t, len_t, len_t, std::vector<int>> TileRecord;
+
+static std::vector<TileRecord> collectTileRecords(const Floorplan &fp){
+    std::vector<TileRecord> records;
+    for(Tile *const &tile : fp.cs->getNonBlankTiles()){
+        std::vector<int> payloadIds;
+        if(tile->getType() == tileType::BLOCK){
+            payloadIds.push_back(tile->getBlockPayload()->getId());
+        }else{
+            for(Rectilinear *const &rt : tile->getOverlapPayload()) payloadIds.push_back(rt->getId());
+        }
+        std::sort(payloadIds.begin(), payloadIds.end());
+        Rectangle rect = tile->getRectangle();
+        records.push_back(TileRecord(int(tile->getType()), rec::getXL(rect), rec::getYL(rect), rec::getXH(rect), rec::getYH(rect), payloadIds));
+    }
+    std::sort(records.begin(), records.end());
+    return records;
+}
+
+// the region covered by the tiles of every rectilinear (allRectilinears order)
+static std::vector<DoughnutPolygonSet> collectRegions(const Floorplan &fp){
+    using namespace boost::polygon::operators;
+    std::vector<DoughnutPolygonSet> regions;
+    for(Rectilinear *const &rt : fp.allRectilinears){
+        DoughnutPolygonSet region;
+        for(Tile *const &tile : rt->blockTiles) region += tile->getRectangle();
+        for(Tile *const &tile : rt->overlapTiles) region += tile->getRectangle();
+        regions.push_back(region);
+    }
+    return regions;
+}
+
+static bool sameRegions(const std::vector<DoughnutPolygonSet> &a, const std::vector<DoughnutPolygonSet> &b){
+    if(a.size() != b.size()) return false;
+    for(size_t i = 0; i < a.size(); ++i){
+        if(!boost::polygon::equivalence(a[i], b[i])) return false;
+    }
+    return true;
+}
+
+// four soft blocks, A & B and B & C overlap, plus one preplaced block
+static GlobalResult buildGlobalResult(){
+    GlobalResult gr;
+    gr.chipWidth = 120;
+    gr.chipHeight = 100;
+    gr.blocks = {
+        {"A", "SOFT", 1200, 0, 0, 40, 30},
+        {"B", "SOFT", 1600, 30, 10, 40, 40},
+        {"C", "SOFT", 1600, 60, 40, 40, 40},
+        {"D", "SOFT", 900, 0, 60, 30, 30},
+        {"P", "FIXED", 400, 100, 0, 20, 20}
+    };
+    gr.blockCount = gr.blocks.size();
+    gr.connections = {
+        {{"A", "B"}, 1.0},
+        {{"B", "C", "D"}, 2.0}
+    };
+    gr.connectionCount = gr.connections.size();
+    return gr;
+}
+
+static Tile *findTile(const Floorplan &fp, tileType type, len_t minWidth, len_t minHeight){
+    for(Tile *const &tile : fp.cs->getNonBlankTiles()){
+        if((tile->getType() == type) && (tile->getWidth() >= minWidth) && (tile->getHeight() >= minHeight)) return tile;
+    }
+    return nullptr;
+}
+
+// dividing tiles fragments the rectilinears, compaction must bring the tile count back down without changing any region
+// (nor reporting any rectilinear as reshaped)
+static bool checkDivideThenCompact(std::string &failure){
+    Floorplan fp(buildGlobalResult(), 0.5, 2.0, 0.8);
+    size_t tileCountBefore, tileCountAfter;
+    fp.compactTiles(tileCountBefore, tileCountAfter);
+    size_t initialTileCount = fp.cs->getNonBlankTiles().size();
+    std::vector<DoughnutPolygonSet> initialRegions = collectRegions(fp);
+
+    Tile *blockTile = findTile(fp, tileType::BLOCK, 2, 2);
+    Tile *overlapTile = findTile(fp, tileType::OVERLAP, 2, 2);
+    if((blockTile == nullptr) || (overlapTile == nullptr)){
+        failure = "divide: no tile to divide";
+        return false;
+    }
+    fp.divideTileHorizontally(blockTile, blockTile->getHeight() / 2);
+    fp.divideTileVertically(blockTile, blockTile->getWidth() / 2);
+    fp.divideTileVertically(overlapTile, overlapTile->getWidth() / 2);
+    if(fp.cs->getNonBlankTiles().size() != initialTileCount + 3){
+        failure = "divide: tile count";
+        return false;
+    }
+
+    FloorplanEventLog eventLog;
+    fp.addObserver(&eventLog);
+    fp.compactTiles(tileCountBefore, tileCountAfter);
+    fp.removeObserver(&eventLog);
+    if((tileCountBefore != initialTileCount + 3) || (tileCountAfter > initialTileCount) || (tileCountAfter != fp.cs->getNonBlankTiles().size())){
+        failure = "compact: tile count " + std::to_string(tileCountBefore) + " -> " + std::to_string(tileCountAfter);
+        return false;
+    }
+    if(!sameRegions(collectRegions(fp), initialRegions)){
+        failure = "compact: rectilinear regions changed";
+        return false;
+    }
+    if(eventLog.events.empty()){
+        failure = "compact: no event reported";
+        return false;
+    }
+    for(FloorplanEvent const &event : eventLog.events){
+        if(!event.reshapedRectilinears.empty()){
+            failure = "compact: re-dice reported as a reshape";
+            return false;
+        }
+    }
+    if(!fp.cs->conductSelfTest()){
+        failure = "compact: plane self test";
+        return false;
+    }
+    return true;
+}
+
+static Rectilinear *findRectilinear(const Floorplan &fp, const std::string &name){
+    for(Rectilinear *const &rt : fp.allRectilinears){
+        if(rt->getName() == name) return rt;
+    }
+    return nullptr;
+}
+
+static Tile *findBlockTile(Rectilinear *rt, len_t minWidth, len_t minHeight){
+    for(Tile *const &tile : rt->blockTiles){
+        if((tile->getWidth() >= minWidth) && (tile->getHeight() >= minHeight)) return tile;
+    }
+    return nullptr;
+}
+
+// one primitive edit of every kind the journal records, tiles are looked up again before each edit
+static bool applyEdits(Floorplan &fp, int firstEdit, int lastEdit, std::string &failure){
+    Rectilinear *a = findRectilinear(fp, "A"), *b = findRectilinear(fp, "B"), *c = findRectilinear(fp, "C"), *d = findRectilinear(fp, "D");
+    for(int edit = firstEdit; edit <= lastEdit; ++edit){
+        Tile *tile = nullptr;
+        switch (edit){
+        case 0:
+            fp.addBlockTile(Rectangle(75, 0, 95, 8), a);
+            break;
+        case 1:
+            tile = findBlockTile(c, 2, 2);
+            if(tile != nullptr) fp.divideTileHorizontally(tile, tile->getHeight() / 2);
+            break;
+        case 2:
+            tile = findBlockTile(d, 2, 2);
+            if(tile != nullptr) fp.increaseTileOverlap(tile, a);
+            break;
+        case 3:
+            tile = (b->overlapTiles.empty())? nullptr : *(b->overlapTiles.begin());
+            if(tile != nullptr) fp.decreaseTileOverlap(tile, b);
+            break;
+        case 4:
+            tile = findBlockTile(b, 1, 1);
+            if(tile != nullptr) fp.moveTileParent(tile, b, c);
+            break;
+        case 5:
+            tile = findBlockTile(c, 3, 3);
+            if(tile != nullptr){
+                Rectangle rect = tile->getRectangle();
+                fp.generalSplitTile(tile, Rectangle(rec::getXL(rect) + 1, rec::getYL(rect) + 1, rec::getXH(rect) - 1, rec::getYH(rect) - 1));
+            }
+            break;
+        default:
+            tile = findBlockTile(a, 1, 1);
+            if(tile != nullptr) fp.deleteTile(tile);
+            break;
+        }
+        if((edit != 0) && (tile == nullptr)){
+            failure = "edit " + std::to_string(edit) + ": no tile to edit";
+            return false;
+        }
+    }
+    return true;
+}
+
+// rollback must bring back the exact tiles, and report the undo to the observers so the HPWL & legality caches follow
+static bool checkTransactionRollback(std::string &failure){
+    Floorplan fp(buildGlobalResult(), 0.5, 2.0, 0.8);
+    std::vector<TileRecord> initialTiles = collectTileRecords(fp);
+    size_t initialOverlapTileCount = fp.getOverlapTileCount();
+    double initialHPWL = fp.calculateHPWL();
+    rectilinearIllegalType initialIllegalType;
+    Rectilinear *initialIllegal = fp.checkFloorplanLegal(initialIllegalType);
+
+    fp.beginTransaction();
+    if(!applyEdits(fp, 0, 6, failure)) return false;
+    if(collectTileRecords(fp) == initialTiles){
+        failure = "rollback: the edits left the tiles unchanged";
+        return false;
+    }
+    // bring the caches up to date with the edited floorplan, rollback has to invalidate them again
+    double editedHPWL = fp.calculateHPWL();
+    rectilinearIllegalType editedIllegalType;
+    fp.checkFloorplanLegal(editedIllegalType);
+
+    FloorplanEventLog eventLog;
+    fp.addObserver(&eventLog);
+    fp.rollback();
+    fp.removeObserver(&eventLog);
+
+    if(collectTileRecords(fp) != initialTiles){
+        failure = "rollback: tiles differ from the original plane";
+        return false;
+    }
+    if(fp.getOverlapTileCount() != initialOverlapTileCount){
+        failure = "rollback: overlap tile count";
+        return false;
+    }
+    if(eventLog.events.empty()){
+        failure = "rollback: undo reported no event";
+        return false;
+    }
+    double rolledBackHPWL = fp.calculateHPWL();
+    if(rolledBackHPWL != initialHPWL){
+        failure = "rollback: HPWL " + std::to_string(rolledBackHPWL) + " (edited " + std::to_string(editedHPWL) + "), expected " + std::to_string(initialHPWL);
+        return false;
+    }
+    rectilinearIllegalType rolledBackIllegalType;
+    if((fp.checkFloorplanLegal(rolledBackIllegalType) != initialIllegal) || (rolledBackIllegalType != initialIllegalType)){
+        failure = "rollback: legality verdict";
+        return false;
+    }
+    if(!fp.cs->conductSelfTest()){
+        failure = "rollback: plane self test";
+        return false;
+    }
+    return true;
+}
+
+// an inner rollback only undoes the inner edits, an inner commit leaves its edits to the enclosing transaction
+static bool checkNestedTransactions(std::string &failure){
+    Floorplan fp(buildGlobalResult(), 0.5, 2.0, 0.8);
+    std::vector<TileRecord> initialTiles = collectTileRecords(fp);
+
+    fp.beginTransaction();
+    if(!applyEdits(fp, 0, 1, failure)) return false;
+    std::vector<TileRecord> outerTiles = collectTileRecords(fp);
+
+    fp.beginTransaction();
+    if(!applyEdits(fp, 2, 3, failure)) return false;
+    fp.rollback();
+    if(collectTileRecords(fp) != outerTiles){
+        failure = "nested: inner rollback did not stop at its mark";
+        return false;
+    }
+
+    fp.beginTransaction();
+    if(!applyEdits(fp, 4, 6, failure)) return false;
+    fp.commit();
+    if(collectTileRecords(fp) == outerTiles){
+        failure = "nested: inner commit dropped its edits";
+        return false;
+    }
+
+    fp.rollback();
+    if(collectTileRecords(fp) != initialTiles){
+        failure = "nested: outer rollback did not undo the committed inner edits";
+        return false;
+    }
+
+    bool thrown = false;
+    try{
+        fp.rollback();
+    }catch(CSException &e){
+        thrown = true;
+    }
+    if(!thrown){
+        failure = "nested: rollback without a transaction did not throw";
+        return false;
+    }
+    return true;
+}
+
+static bool samePayload(const Tile *tile, std::vector<Rectilinear *> expected){
+    std::vector<Rectilinear *> payload(tile->getOverlapPayload().begin(), tile->getOverlapPayload().end());
+    std::sort(payload.begin(), payload.end());
+    std::sort(expected.begin(), expected.end());
+    return payload == expected;
+}
+
+// an overlap tile with more owners than its payload keeps inline must survive growing, dividing, shrinking, copying & rollback
+static bool checkOverlapPayloadSpill(std::string &failure){
+    Floorplan fp(buildGlobalResult(), 0.5, 2.0, 0.8);
+    std::vector<TileRecord> initialTiles = collectTileRecords(fp);
+    Rectilinear *a = findRectilinear(fp, "A"), *b = findRectilinear(fp, "B"), *c = findRectilinear(fp, "C"), *d = findRectilinear(fp, "D");
+    Rectilinear *p = findRectilinear(fp, "P");
+    if(b->overlapTiles.empty()){
+        failure = "no overlap tile between A and B";
+        return false;
+    }
+    Tile *tile = *(b->overlapTiles.begin());
+
+    fp.beginTransaction();
+    std::vector<Rectilinear *> owners = {a, b};
+    for(Rectilinear *const &newOwner : {c, d, p}){
+        fp.increaseTileOverlap(tile, newOwner);
+        owners.push_back(newOwner);
+        if(!samePayload(tile, owners)){
+            failure = std::to_string(owners.size()) + " owners after increaseTileOverlap";
+            return false;
+        }
+    }
+
+    Tile *lower = fp.divideTileHorizontally(tile, tile->getHeight() / 2);
+    if(!samePayload(tile, owners) || !samePayload(lower, owners)){
+        failure = "divided tiles lost owners";
+        return false;
+    }
+
+    Floorplan copy(fp);
+    if(collectTileRecords(copy) != collectTileRecords(fp)){
+        failure = "copy of the spilled payloads";
+        return false;
+    }
+
+    fp.decreaseTileOverlap(lower, c);
+    if(!samePayload(lower, {a, b, d, p}) || !samePayload(tile, owners)){
+        failure = "decreaseTileOverlap from a spilled payload";
+        return false;
+    }
+
+    fp.rollback();
+    if(collectTileRecords(fp) != initialTiles){
+        failure = "rollback: tiles differ from the original plane";
+        return false;
+    }
+    return true;
+}
+
+// source tiles of frozen tile indices, sorted so they compare with the tiles of a live query regardless of order
+static std::vector<Tile *> toSourceTiles(const FrozenPlane &frozen, const int *first, const int *last){
+    std::vector<Tile *> tiles;
+    for(const int *idx = first; idx != last; ++idx) tiles.push_back(frozen.getSourceTile(*idx));
+    std::sort(tiles.begin(), tiles.end());
+    return tiles;
+}
+
+// every point, area, neighbor and payload query of a FrozenPlane must answer what the live plane it was frozen from answers
+static bool checkFrozenPlane(std::string &failure){
+    CornerStitching emptyPlane(50, 40);
+    FrozenPlane frozenEmpty(emptyPlane);
+    if((frozenEmpty.getTileCount() != 1) || (frozenEmpty.getSourceTile(frozenEmpty.findPoint(Cord(49, 39))) != emptyPlane.findPoint(Cord(49, 39)))){
+        failure = "empty plane";
+        return false;
+    }
+
+    Floorplan fp(buildGlobalResult(), 0.5, 2.0, 0.8);
+    if(!applyEdits(fp, 0, 6, failure)) return false;
+    FrozenPlane frozen(fp);
+    const CornerStitching &cs = *fp.cs;
+
+    for(len_t y = 0; y < cs.getCanvasHeight(); ++y){
+        for(len_t x = 0; x < cs.getCanvasWidth(); ++x){
+            if(frozen.getSourceTile(frozen.findPoint(Cord(x, y))) != cs.findPoint(Cord(x, y))){
+                failure = "findPoint(" + std::to_string(x) + ", " + std::to_string(y) + ")";
+                return false;
+            }
+        }
+    }
+
+    for(len_t y = 0; y < cs.getCanvasHeight(); y += 11){
+        for(len_t x = 0; x < cs.getCanvasWidth(); x += 13){
+            for(len_t side : {len_t(1), len_t(17), len_t(60)}){
+                Rectangle box(x, y, std::min(x + side, cs.getCanvasWidth()), std::min(y + side + 6, cs.getCanvasHeight()));
+                std::vector<int> frozenTiles;
+                frozen.enumerateArea(box, frozenTiles);
+                std::vector<Tile *> liveTiles;
+                cs.enumerateDirectedArea(box, liveTiles);
+                std::sort(liveTiles.begin(), liveTiles.end());
+                if(toSourceTiles(frozen, frozenTiles.data(), frozenTiles.data() + frozenTiles.size()) != liveTiles){
+                    failure = "enumerateArea at (" + std::to_string(x) + ", " + std::to_string(y) + "), side " + std::to_string(side);
+                    return false;
+                }
+            }
+        }
+    }
+
+    for(int t = 0; t < frozen.getTileCount(); ++t){
+        Tile *tile = frozen.getSourceTile(t);
+        for(direction2D side : {direction2D::UP, direction2D::LEFT, direction2D::DOWN, direction2D::RIGHT}){
+            std::vector<int> frozenNeighbors;
+            frozen.findNeighbors(t, side, frozenNeighbors);
+            std::vector<Tile *> liveNeighbors;
+            if(side == direction2D::UP) cs.findTopNeighbors(tile, liveNeighbors);
+            else if(side == direction2D::LEFT) cs.findLeftNeighbors(tile, liveNeighbors);
+            else if(side == direction2D::DOWN) cs.findDownNeighbors(tile, liveNeighbors);
+            else cs.findRightNeighbors(tile, liveNeighbors);
+            std::sort(liveNeighbors.begin(), liveNeighbors.end());
+            if(toSourceTiles(frozen, frozenNeighbors.data(), frozenNeighbors.data() + frozenNeighbors.size()) != liveNeighbors){
+                failure = "findNeighbors of tile " + std::to_string(t);
+                return false;
+            }
+        }
+
+        std::vector<Rectilinear *> livePayload;
+        if(tile->getType() == tileType::BLOCK) livePayload.push_back(tile->getBlockPayload());
+        else if(tile->getType() == tileType::OVERLAP) livePayload.assign(tile->getOverlapPayload().begin(), tile->getOverlapPayload().end());
+        std::vector<Rectilinear *> frozenPayload;
+        std::pair<const int *, const int *> payloadSpan = frozen.getTilePayload(t);
+        for(const int *rectIdx = payloadSpan.first; rectIdx != payloadSpan.second; ++rectIdx) frozenPayload.push_back(frozen.getRectilinear(*rectIdx));
+        std::sort(livePayload.begin(), livePayload.end());
+        std::sort(frozenPayload.begin(), frozenPayload.end());
+        if(frozenPayload != livePayload){
+            failure = "payload of tile " + std::to_string(t);
+            return false;
+        }
+    }
+
+    for(int r = 0; r < frozen.getRectilinearCount(); ++r){
+        Rectilinear *rt = frozen.getRectilinear(r);
+        std::vector<Tile *> liveTiles(rt->blockTiles.begin(), rt->blockTiles.end());
+        liveTiles.insert(liveTiles.end(), rt->overlapTiles.begin(), rt->overlapTiles.end());
+        std::sort(liveTiles.begin(), liveTiles.end());
+        std::pair<const int *, const int *> tileSpan = frozen.getRectilinearTiles(r);
+        if(toSourceTiles(frozen, tileSpan.first, tileSpan.second) != liveTiles){
+            failure = "tiles of rectilinear " + rt->getName();
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(){
+    typedef bool (*Check)(std::string &failure);
+    std::vector<std::pair<std::string, Check>> checks = {
+        {"divideThenCompact", checkDivideThenCompact},
+        {"transactionRollback", checkTransactionRollback},
+        {"nestedTransactions", checkNestedTransactions},
+        {"overlapPayloadSpill", checkOverlapPayloadSpill},
+        {"frozenPlane", checkFrozenPlane}
+    };
+
+    for(std::pair<std::string, Check> const &check : checks){
+        std::string failure;
+        if(!check.second(failure)){
+            std::cout << "FAIL " << check.first << ": " << failure << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "ok " << checks.size() << " checks" << std::endl;
+    return 0;
+}
@@ -41,6 +41,13 @@ inline std::unordered_map<std::string, const char*> CSEXCEPTION_LUT = {
     {"CORNERSTITCHING_21", "findLineTileHorizontalNegative(...): the input Tile *initTile is nullptr"},
     {"CORNERSTITCHING_22", "findLineTileVerticalPositive(...): the input Tile *initTile is nullptr"},
     {"CORNERSTITCHING_23", "findLineTileVerticalNegative(...): the input Tile *initTile is nullptr"},
+    {"CORNERSTITCHING_24", "bulkLoad(...): the plane already contains non-blank tiles, bulk loading requires an empty plane"},
+    {"CORNERSTITCHING_25", "bulkLoad(...): input tile prototype is tileType::BLANK or out of canvas"},
+    {"CORNERSTITCHING_26", "bulkLoad(...): input tile prototypes overlap each other"},
+    {"CORNERSTITCHING_27", "endBatch(): no batch is open, endBatch() is called more times than beginBatch()"},
+    {"CORNERSTITCHING_28", "findBlankExtension(...): direction should be either UP, DOWN, LEFT, RIGHT, others are prohibited"},
+    {"CORNERSTITCHING_29", "relayoutTiles(std::unordered_map<Tile *, Tile *> &oldNewTiles): the plane is inside a batch (beginBatch() without endBatch())"},
+    {"CORNERSTITCHING_30", "checkLocalInvariants(...): the tiles around the last insertTile/removeTile/generalSplitTile violate the corner stitching invariants"},
 
     {"RECTILINEAR_01", "calculateBoundingBox(): there exist no tile in rectilinear"},
     {"RECTILINEAR_02", "acquireWinding(): there exist no tile in rectilinear"},
@@ -80,6 +87,9 @@ inline std::unordered_map<std::string, const char*> CSEXCEPTION_LUT = {
     {"FLOORPLAN_25", "addOverlapTile(...): rectilinearType::PIN cannot perform block tile adding"},
     {"FLOORPLAN_26", "increaseTileOverlap(Tile *tile, Rectilinear *newRect): newRect cannot be rectilinearType::PIN"},
     {"FLOORPLAN_27", "calculateOptimalCentre(Rectilinear *rect): input Rectilinear *rect is not rectilinear::SOFT type"},
+    {"FLOORPLAN_28", "restoreSnapshot(size_t snapshot): snapshot is not alive or lies beyond the edit journal"},
+    {"FLOORPLAN_29", "restoreSnapshot(size_t snapshot): journalled tile does not match any tile in the floorplan"},
+    {"FLOORPLAN_30", "commit()/rollback(): there is no transaction in progress"},
 
     {"LEGALRESULT_01", "readLegalResult(std::string legalResultFile): file stream not open"},
     {"LEGALRESULT_02", "readLegalResult(const std::ifstream &ifs): file stream not open"},
@@ -105,6 +115,11 @@ inline std::unordered_map<std::string, const char*> CSEXCEPTION_LUT = {
     {"LINETILE_08", "LineTile(Line line, Tile tile): VERTICAL mode, line's x coordinate over tile's x range"},
     {"LINETILE_09", "LineTile(Line line, Tile tile): VERTICAL mode, line's x coordinate under tile's x range"},
 
+    {"TILENEIGHBOR_01", "TileNeighborRange(Tile *centre, direction2D side): side should be either UP, LEFT, DOWN, RIGHT, others are prohibited"},
+
+    {"FROZENPLANE_01", "findPoint(const Cord &key): key is out of canvas"},
+    {"FROZENPLANE_02", "findNeighbors(int tileIdx, direction2D side, std::vector<int> &neighbors): side should be either UP, LEFT, DOWN, RIGHT, others are prohibited"},
+
     {"LEGALISEENGINE_01", "legalise(): the growing direction is not within direction2D::UP, LEFT, DOWN, RIGHT"},
 
     {"DOUGHNUTPOLYGONSET_01", "operator <<: doughnutPolygonSetIllegalType &t is not in switch type"},
@@ -1,8 +1,56 @@
 #include <fstream>
+#include <new>
+#include <atomic>
+#include <map>
+#include <algorithm>
+#include <numeric>
+#include <exception>
+#include <type_traits>
 
 #include "cornerStitching.h"
 #include "cSException.h"
 
+// every CornerStitching receives a unique plane ID, 0 is reserved for "no plane"
+static std::atomic<unsigned long long> planeIDCounter(0);
+
+// Per-thread memory of the last point-finding answer, the next findPoint() walk starts here.
+// The answer is only trusted if it comes from the same plane and the tile itself is not freed since.
+struct PointFindingMemory{
+	unsigned long long planeID;
+	unsigned long long tileDeleteEpoch;
+	Tile *tile;
+};
+static thread_local PointFindingMemory lastPointFound = {0, 0, nullptr};
+
+// position on the Z-order curve, twice as wide as len_t so both cords are interleaved without loss
+#ifdef COORDINATE_64BIT
+typedef unsigned __int128 mortonCode_t;
+#else
+typedef unsigned long long mortonCode_t;
+#endif
+
+// position of a point on the Z-order (Morton) curve, interleaves the bits of x and y cords
+static mortonCode_t mortonCode(const Cord &point){
+	typedef std::make_unsigned<len_t>::type ulen_t;
+	mortonCode_t code = 0;
+	mortonCode_t x = mortonCode_t(ulen_t(point.x()));
+	mortonCode_t y = mortonCode_t(ulen_t(point.y()));
+	for(int bit = 0; bit < int(8 * sizeof(len_t)); ++bit){
+		code |= ((x >> bit) & 1) << (2 * bit);
+		code |= ((y >> bit) & 1) << (2 * bit + 1);
+	}
+	return code;
+}
+
+// Runs debugCheckLocalInvariants(area) once the guarded edit returns, whichever return path it takes (skipped while an exception unwinds)
+struct LocalInvariantGuard{
+	const CornerStitching *plane;
+	Rectangle area;
+	~LocalInvariantGuard() noexcept(false){
+		if(std::uncaught_exceptions() == 0) plane->debugCheckLocalInvariants(area);
+	}
+};
+
 bool CornerStitching::checkPointInCanvas(const Cord &point) const{
 	return rec::isContained(mCanvasSizeBlankTile->getRectangle(), point);
 }
@@ -13,77 +61,185 @@ bool CornerStitching::checkRectangleInCanvas(const Rectangle &rect) const{
 
 void CornerStitching::collectAllTiles(std::unordered_set<Tile *> &allTiles) const{
 	// If there are no tiles, just return the blank tile
-	if(mAllNonBlankTilesMap.empty()){
+	if(mNonBlankTiles.empty()){
 		allTiles.insert(this->mCanvasSizeBlankTile);
 		return;
 	}
 
-	// call herlper function, Use DFS to travese the entire graph, this funciton uses a random tile as seed.
-	collectAllTilesDFS(mAllNonBlankTilesMap.begin()->second, allTiles);
+	// every tile of the plane sits in one of the registries
+	allTiles.reserve(allTiles.size() + mNonBlankTiles.size() + mBlankTiles.size());
+	allTiles.insert(mNonBlankTiles.begin(), mNonBlankTiles.end());
+	allTiles.insert(mBlankTiles.begin(), mBlankTiles.end());
 }
 
 void CornerStitching::collectAllTilesDFS(Tile *currentSearch, std::unordered_set<Tile *> &allTiles) const{
-	
+	// explicit stack instead of recursion, the depth of the search grows with the tile count
+	std::vector<Tile *> toVisit = {currentSearch};
 	allTiles.insert(currentSearch);
-	
-	if(currentSearch->rt != nullptr){
-		if(allTiles.find(currentSearch->rt) == allTiles.end()){
-			collectAllTilesDFS(currentSearch->rt, allTiles);
+
+	while(!toVisit.empty()){
+		Tile *tile = toVisit.back();
+		toVisit.pop_back();
+
+		for(Tile *const &stitch : {tile->rt, tile->tr, tile->bl, tile->lb}){
+			if((stitch != nullptr) && allTiles.insert(stitch).second){
+				toVisit.push_back(stitch);
+			}
 		}
 	}
-	if(currentSearch->tr != nullptr){
-		if(allTiles.find(currentSearch->tr) == allTiles.end()){
-			collectAllTilesDFS(currentSearch->tr, allTiles);
-		}
+}
+
+void CornerStitching::freeTile(Tile *tile){
+	if(tile->mRegistryIndex >= 0) unregisterTile(tile);
+	reseedGrid(tile->getRectangle(), tile, nullptr);
+	if(mBatchDepth > 0) mBatchDirtyTiles.erase(tile);
+	++mTileDeleteEpoch;
+	mRecentlyFreedTiles[mTileDeleteEpoch % RECENTLY_FREED_TILE_COUNT] = tile;
+	releaseTileMemory(tile);
+}
+
+bool CornerStitching::isTileAliveSince(const Tile *tile, unsigned long long tileEpoch) const{
+	if(mTileDeleteEpoch - tileEpoch > RECENTLY_FREED_TILE_COUNT) return false;
+	for(unsigned long long epoch = tileEpoch + 1; epoch <= mTileDeleteEpoch; ++epoch){
+		if(mRecentlyFreedTiles[epoch % RECENTLY_FREED_TILE_COUNT] == tile) return false;
 	}
-	if(currentSearch->bl != nullptr){
-		if(allTiles.find(currentSearch->bl) == allTiles.end()){
-			collectAllTilesDFS(currentSearch->bl, allTiles);
+	return true;
+}
+
+void CornerStitching::registerTile(Tile *tile){
+	std::vector<Tile *> &registry = (tile->getType() == tileType::BLANK)? mBlankTiles : mNonBlankTiles;
+	tile->mRegistryIndex = registry.size();
+	registry.push_back(tile);
+}
+
+void CornerStitching::unregisterTile(Tile *tile){
+	std::vector<Tile *> &registry = (tile->getType() == tileType::BLANK)? mBlankTiles : mNonBlankTiles;
+	assert(registry[tile->mRegistryIndex] == tile);
+	Tile *lastTile = registry.back();
+	registry[tile->mRegistryIndex] = lastTile;
+	lastTile->mRegistryIndex = tile->mRegistryIndex;
+	registry.pop_back();
+	tile->mRegistryIndex = -1;
+}
+
+void CornerStitching::retypeTile(Tile *tile, tileType type){
+	unregisterTile(tile);
+	tile->setType(type);
+	registerTile(tile);
+}
+
+void CornerStitching::releaseTileMemory(Tile *tile){
+	if(!mTileArenas.empty()){
+		std::map<Tile *, std::pair<size_t, size_t>>::iterator it = mTileArenas.upper_bound(tile);
+		if(it != mTileArenas.begin()){
+			--it;
+			if(std::less<Tile *>()(tile, it->first + it->second.first)){
+				tile->~Tile();
+				if(--(it->second.second) == 0){
+					::operator delete(it->first);
+					mTileArenas.erase(it);
+				}
+				return;
+			}
 		}
 	}
-	if(currentSearch->lb != nullptr){
-		if(allTiles.find(currentSearch->lb) == allTiles.end()){
-			collectAllTilesDFS(currentSearch->lb, allTiles);
+	delete(tile);
+}
+
+void CornerStitching::allocateSeedGrid(int cellCount){
+	std::vector<std::atomic<Tile *>>(cellCount).swap(mSeedGrid);
+	for(std::atomic<Tile *> &cell : mSeedGrid){
+		cell.store(nullptr, std::memory_order_relaxed);
+	}
+}
+
+std::atomic<Tile *> *CornerStitching::findSeedGridCell(const Cord &key) const{
+	if(mSeedGrid.empty()) return nullptr;
+
+	int column = std::min(int(key.x() / mSeedGridCellWidth), mSeedGridColumns - 1);
+	int row = std::min(int(key.y() / mSeedGridCellHeight), mSeedGridRows - 1);
+	return &(mSeedGrid[row * mSeedGridColumns + column]);
+}
+
+void CornerStitching::reseedGrid(const Rectangle &area, Tile *oldSeed, Tile *newSeed){
+	if(mSeedGrid.empty()) return;
+
+	int columnBegin = std::min(int(rec::getXL(area) / mSeedGridCellWidth), mSeedGridColumns - 1);
+	int columnEnd = std::min(int((rec::getXH(area) - 1) / mSeedGridCellWidth), mSeedGridColumns - 1);
+	int rowBegin = std::min(int(rec::getYL(area) / mSeedGridCellHeight), mSeedGridRows - 1);
+	int rowEnd = std::min(int((rec::getYH(area) - 1) / mSeedGridCellHeight), mSeedGridRows - 1);
+
+	for(int row = rowBegin; row <= rowEnd; ++row){
+		for(int column = columnBegin; column <= columnEnd; ++column){
+			std::atomic<Tile *> &cell = mSeedGrid[row * mSeedGridColumns + column];
+			if(cell.load(std::memory_order_relaxed) == oldSeed) cell.store(newSeed, std::memory_order_relaxed);
 		}
 	}
 }
 
-void CornerStitching::enumerateDirectedAreaRProcedure(Rectangle box, std::vector <Tile *> &allTiles, Tile *targetTile) const{
+void CornerStitching::copyPlane(const CornerStitching &other, std::unordered_map<Tile *, Tile *> &oldNewPairs){
+	this->mCanvasWidth = other.mCanvasWidth;
+	this->mCanvasHeight = other.mCanvasHeight;
+	this->mCanvasSizeBlankTile = new Tile(*(other.mCanvasSizeBlankTile));
+	
+	oldNewPairs.clear();
+	if(other.mNonBlankTiles.empty()) return;
 
-	// R1) Enumerate the tile
-	tileType targetTileType = targetTile->getType();
-	if((targetTileType == tileType::BLOCK) ||(targetTileType == tileType::OVERLAP)){
-		allTiles.push_back(targetTile);
+	std::unordered_set <Tile *> oldAllTiles;
+	other.collectAllTiles(oldAllTiles);
+
+	oldNewPairs.reserve(oldAllTiles.size());
+	for(Tile *const &oldTile : oldAllTiles){
+		oldNewPairs[oldTile] = new Tile(*oldTile);
 	}
 
-	// R2) If the right edge of the tile is outside (or touch) the seearch area, return
-	if(targetTile->getXHigh() >= rec::getXH(box)) return;
+	// the copies keep the registry index of their originals, so the registries are copied in the same order
+	this->mNonBlankTiles.resize(other.mNonBlankTiles.size());
+	for(size_t i = 0; i < other.mNonBlankTiles.size(); ++i){
+		this->mNonBlankTiles[i] = oldNewPairs[other.mNonBlankTiles[i]];
+	}
+	this->mBlankTiles.resize(other.mBlankTiles.size());
+	for(size_t i = 0; i < other.mBlankTiles.size(); ++i){
+		this->mBlankTiles[i] = oldNewPairs[other.mBlankTiles[i]];
+	}
 
-	// R3) Use neighbor-finding algo to locate all the tiles that touch the right side of the current tile and also intersect the search area
-	std::vector<Tile *> rightNeighbors;
-	findRightNeighbors(targetTile, rightNeighbors);
+	// maintain the pointers of the new Tiles
+	for(std::unordered_map <Tile *, Tile *>::iterator it = oldNewPairs.begin(); it != oldNewPairs.end(); ++it){
 
-	Rectangle targetTileRect = targetTile->getRectangle();
+		Tile *father = it->first;
+		Tile *son = it->second;
 
-	for(Tile *const &t : rightNeighbors){
-		// make sure the tile is in the AOI
-		if(!rec::hasIntersect(t->getRectangle(), box, false)) continue;
+		// maintain the links using the map data-structure
+		if(father->rt == nullptr) son->rt = nullptr;
+		else son->rt = oldNewPairs[father->rt];
+		
+		if(father->tr == nullptr) son->tr = nullptr;
+		else son->tr = oldNewPairs[father->tr];
 
-		// R4) If bottom left corner of the neighbor touches the current tile
-		bool R4 = (t->getYLow() >= targetTile->getYLow());
+		if(father->bl == nullptr) son->bl = nullptr;
+		else son->bl = oldNewPairs[father->bl];
 
-		// R5) If the bottom edge ofthe search area cuts both the target tile and its neighbor
-		len_t bottomEdge = rec::getYL(box);
-		bool cutTargetTile = (targetTile->getYLow() <= bottomEdge) && (targetTile->getYHigh() > bottomEdge);
-		bool cutNeighbor = (t->getYLow() <= bottomEdge) && (t->getYHigh() > bottomEdge);
-		bool R5 = cutTargetTile && cutNeighbor;
+		if(father->lb == nullptr) son->lb = nullptr;
+		else son->lb = oldNewPairs[father->lb];
+	}
 
-		if(R4 || R5) enumerateDirectedAreaRProcedure(box, allTiles, t);
+	// the seed grid remembers the copies of the same tiles
+	for(size_t i = 0; i < mSeedGrid.size(); ++i){
+		Tile *otherSeed = other.mSeedGrid[i].load(std::memory_order_relaxed);
+		if(otherSeed != nullptr) mSeedGrid[i].store(oldNewPairs[otherSeed], std::memory_order_relaxed);
 	}
+}
 
+Tile *CornerStitching::findNextTileDownLine(Tile *tile, len_t x) const{
+	// lb lies right below the lower-left corner of tile, move right along its row until x is reached
+	Tile *nextTile = tile->lb;
+	while(nextTile->getXHigh() <= x){
+		nextTile = nextTile->tr;
+	}
+	return nextTile;
 }
 
-void CornerStitching::findLineTileHorizontalPositive(Tile *initTile, Line line, std::vector<LineTile> &positiveSide){
+void CornerStitching::findLineTileHorizontalPositive(Tile *initTile, Line line, std::vector<LineTile> &positiveSide) const{
 
 	if(initTile == nullptr){
 		throw CSException("CORNERSTITCHING_20");
@@ -150,7 +306,7 @@ void CornerStitching::findLineTileHorizontalPositive(Tile *initTile, Line line,
 	if(indexXHigh < lineXHigh) findLineTileHorizontalPositive(index, Line(inTileCordRight, line.getHigh()), positiveSide);
 }
 
-void CornerStitching::findLineTileHorizontalNegative(Tile *initTile, Line line, std::vector<LineTile> &negativeSide){
+void CornerStitching::findLineTileHorizontalNegative(Tile *initTile, Line line, std::vector<LineTile> &negativeSide) const{
 
 	if(initTile == nullptr){
 		throw CSException("CORNERSTITCHING_21");
@@ -217,7 +373,7 @@ void CornerStitching::findLineTileHorizontalNegative(Tile *initTile, Line line,
 	if(indexXHigh < lineXHigh) findLineTileHorizontalNegative(index, Line(inTileCordRight, line.getHigh()), negativeSide);
 }
 
-void CornerStitching::findLineTileVerticalPositive(Tile *initTile, Line line, std::vector<LineTile> &positiveSide){
+void CornerStitching::findLineTileVerticalPositive(Tile *initTile, Line line, std::vector<LineTile> &positiveSide) const{
 
 	// if(initTile == nullptr){
 	// 	throw CSException("CORNERSTITCHING_22");
@@ -282,7 +438,7 @@ void CornerStitching::findLineTileVerticalPositive(Tile *initTile, Line line, st
 	if(indexYHigh < lineYHigh) findLineTileVerticalPositive(index, Line(inTileCordUp, line.getHigh()), positiveSide);
 }
 
-void CornerStitching::findLineTileVerticalNegative(Tile *initTile, Line line, std::vector<LineTile> &negativeSide){
+void CornerStitching::findLineTileVerticalNegative(Tile *initTile, Line line, std::vector<LineTile> &negativeSide) const{
 
 	// if(initTile == nullptr){
 	// 	throw CSException("CORNERSTITCHING_23");
@@ -349,70 +505,49 @@ void CornerStitching::findLineTileVerticalNegative(Tile *initTile, Line line, st
 }
 
 CornerStitching::CornerStitching()
-	: mCanvasWidth(1), mCanvasHeight(1) {
+	: mCanvasWidth(1), mCanvasHeight(1), mPlaneID(++planeIDCounter), mTileDeleteEpoch(0), mBatchDepth(0), mBatchStripsBroken(false),
+	mSeedGridCellWidth(1), mSeedGridCellHeight(1), mSeedGridColumns(0), mSeedGridRows(0) {
 		mCanvasSizeBlankTile = new Tile(tileType::BLANK, Cord(0, 0), 1, 1);
 }
 
 CornerStitching::CornerStitching(len_t chipWidth, len_t chipHeight)
-	: mCanvasWidth(chipWidth), mCanvasHeight(chipHeight) {
+	: mCanvasWidth(chipWidth), mCanvasHeight(chipHeight), mPlaneID(++planeIDCounter), mTileDeleteEpoch(0), mBatchDepth(0), mBatchStripsBroken(false),
+	mSeedGridCellWidth(1), mSeedGridCellHeight(1), mSeedGridColumns(0), mSeedGridRows(0) {
 		// if((chipWidth <= 0) || (chipHeight <= 0)){
 		// 	throw CSException("CORNERSTITCHING_04");
 		// }
 		mCanvasSizeBlankTile = new Tile(tileType::BLANK, Cord(0, 0), chipWidth, chipHeight);
 }
 
-CornerStitching::CornerStitching(const CornerStitching &other){
-	this->mCanvasWidth = other.mCanvasWidth;
-	this->mCanvasHeight = other.mCanvasHeight;
-	this->mCanvasSizeBlankTile = new Tile(*(other.mCanvasSizeBlankTile));
+CornerStitching::CornerStitching(const CornerStitching &other)
+	: mPlaneID(++planeIDCounter), mTileDeleteEpoch(0), mBatchDepth(0), mBatchStripsBroken(false),
+	mSeedGridCellWidth(other.mSeedGridCellWidth), mSeedGridCellHeight(other.mSeedGridCellHeight),
+	mSeedGridColumns(other.mSeedGridColumns), mSeedGridRows(other.mSeedGridRows) {
 	
-	if(other.mAllNonBlankTilesMap.size() == 0) return;
-
-	std::unordered_set <Tile *> oldAllTiles;
-	other.collectAllTiles(oldAllTiles);
-
+	allocateSeedGrid(other.mSeedGrid.size());
 	std::unordered_map <Tile *, Tile *> oldNewPairs;
-	for(Tile *const &oldTile : oldAllTiles){
-		oldNewPairs[oldTile] = new Tile(*oldTile);
-	}
-
-	// maintain the pointers of the new Tiles, while simultanuously maintain mAllNonBlankTilesMap
-	for(std::unordered_map <Tile *, Tile *>::iterator it = oldNewPairs.begin(); it != oldNewPairs.end(); ++it){
-
-		Tile *father = it->first;
-		Tile *son = it->second;
-
-		// insert to mAllNonBlankTilesMap if tile is not BLANK
-		if(son->getType() != tileType::BLANK){
-			this->mAllNonBlankTilesMap[son->getLowerLeft()] = son;
-		}
-
-		// maintain the links using the map data-structure
-		if(father->rt == nullptr) son->rt = nullptr;
-		else son->rt = oldNewPairs[father->rt];
-		
-		if(father->tr == nullptr) son->tr = nullptr;
-		else son->tr = oldNewPairs[father->tr];
-
-		if(father->bl == nullptr) son->bl = nullptr;
-		else son->bl = oldNewPairs[father->bl];
+	copyPlane(other, oldNewPairs);
+}
 
-		if(father->lb == nullptr) son->lb = nullptr;
-		else son->lb = oldNewPairs[father->lb];
-	}
+CornerStitching::CornerStitching(const CornerStitching &other, std::unordered_map<Tile *, Tile *> &oldNewTiles)
+	: mPlaneID(++planeIDCounter), mTileDeleteEpoch(0), mBatchDepth(0), mBatchStripsBroken(false),
+	mSeedGridCellWidth(other.mSeedGridCellWidth), mSeedGridCellHeight(other.mSeedGridCellHeight),
+	mSeedGridColumns(other.mSeedGridColumns), mSeedGridRows(other.mSeedGridRows) {
 
+	allocateSeedGrid(other.mSeedGrid.size());
+	copyPlane(other, oldNewTiles);
 }
 
 CornerStitching::~CornerStitching(){
 	delete(mCanvasSizeBlankTile);
 
 	// If there is no BLOCK or OVERLAP tiles, remove the only blank tile and return
-	if(mAllNonBlankTilesMap.size() == 0) return;
+	if(mNonBlankTiles.empty()) return;
 	
 	std::unordered_set<Tile *> allOldTiles;
 	collectAllTiles(allOldTiles);
 	for(Tile *const &oldTiles : allOldTiles){
-		delete(oldTiles);
+		releaseTileMemory(oldTiles);
 	}
 
 }
@@ -556,6 +691,88 @@ len_t CornerStitching::getCanvasHeight() const{
 	return this->mCanvasHeight;
 }
 
+const std::vector<Tile *> &CornerStitching::getNonBlankTiles() const{
+	return this->mNonBlankTiles;
+}
+
+const std::vector<Tile *> &CornerStitching::getBlankTiles() const{
+	return this->mBlankTiles;
+}
+
+void CornerStitching::enableSeedGrid(int columns, int rows){
+	assert((columns > 0) && (rows > 0));
+
+	mSeedGridCellWidth = std::max(len_t(1), len_t((mCanvasWidth + columns - 1) / columns));
+	mSeedGridCellHeight = std::max(len_t(1), len_t((mCanvasHeight + rows - 1) / rows));
+	mSeedGridColumns = columns;
+	mSeedGridRows = rows;
+	allocateSeedGrid(columns * rows);
+}
+
+void CornerStitching::disableSeedGrid(){
+	mSeedGridColumns = 0;
+	mSeedGridRows = 0;
+	mSeedGrid.clear();
+}
+
+void CornerStitching::relayoutTiles(std::unordered_map<Tile *, Tile *> &oldNewTiles){
+	if(mBatchDepth > 0){
+		throw CSException("CORNERSTITCHING_29");
+	}
+
+	oldNewTiles.clear();
+	// an empty plane only holds mCanvasSizeBlankTile, nothing to relocate
+	if(mNonBlankTiles.empty()) return;
+
+	std::unordered_set<Tile *> allTiles;
+	collectAllTiles(allTiles);
+
+	// lower-left corners are unique among tiles, so is their position on the curve
+	std::vector<std::pair<mortonCode_t, Tile *>> curveOrder;
+	curveOrder.reserve(allTiles.size());
+	for(Tile *const &tile : allTiles){
+		curveOrder.push_back(std::make_pair(mortonCode(tile->getLowerLeft()), tile));
+	}
+	std::sort(curveOrder.begin(), curveOrder.end());
+
+	size_t tileCount = curveOrder.size();
+	Tile *arena = static_cast<Tile *>(::operator new(sizeof(Tile) * tileCount));
+	oldNewTiles.reserve(tileCount);
+	for(size_t i = 0; i < tileCount; ++i){
+		oldNewTiles[curveOrder[i].second] = new (arena + i) Tile(*(curveOrder[i].second));
+	}
+
+	// the copies still stitch to the old tiles, redirect them
+	for(size_t i = 0; i < tileCount; ++i){
+		Tile *tile = arena + i;
+		if(tile->rt != nullptr) tile->rt = oldNewTiles[tile->rt];
+		if(tile->tr != nullptr) tile->tr = oldNewTiles[tile->tr];
+		if(tile->bl != nullptr) tile->bl = oldNewTiles[tile->bl];
+		if(tile->lb != nullptr) tile->lb = oldNewTiles[tile->lb];
+	}
+
+	// the copies keep their registry index
+	for(Tile *&registered : mNonBlankTiles){
+		registered = oldNewTiles[registered];
+	}
+	for(Tile *&registered : mBlankTiles){
+		registered = oldNewTiles[registered];
+	}
+
+	for(std::atomic<Tile *> &cell : mSeedGrid){
+		Tile *seed = cell.load(std::memory_order_relaxed);
+		if(seed != nullptr) cell.store(oldNewTiles[seed], std::memory_order_relaxed);
+	}
+
+	for(size_t i = 0; i < tileCount; ++i){
+		releaseTileMemory(curveOrder[i].second);
+	}
+	mTileArenas[arena] = std::make_pair(tileCount, tileCount);
+
+	// remembered point-finding answers point to the old tiles, push every remembered epoch out of mRecentlyFreedTiles
+	mTileDeleteEpoch += (RECENTLY_FREED_TILE_COUNT + 1);
+}
+
 Tile *CornerStitching::findPoint(const Cord &key) const{
 
 	// throw exception if point finding (key) out of canvas range
@@ -563,14 +780,40 @@ Tile *CornerStitching::findPoint(const Cord &key) const{
 	// 	throw CSException("CORNERSTITCHING_01");
 	// }
 
-	// Find a seed to start, if empty just return the blank tile.
-	Tile *index;
-	if(mAllNonBlankTilesMap.empty()){
+	// If empty just return the blank tile.
+	if(mNonBlankTiles.empty()){
 		return mCanvasSizeBlankTile;
-	}else{
-		index = mAllNonBlankTilesMap.begin()->second; 
-	} 
+	}
+
+	// Try the last answer of this thread first if it's still alive, it is returned right away when it already includes key.
+	// Otherwise walk from the tile remembered by the seed grid cell (it is close to key), then the last answer, else pick any tile
+	Tile *lastTile = nullptr;
+	if((lastPointFound.planeID == mPlaneID) && isTileAliveSince(lastPointFound.tile, lastPointFound.tileDeleteEpoch)){
+		lastTile = lastPointFound.tile;
+		if(rec::isContained(lastTile->getRectangle(), key)){
+			lastPointFound.tileDeleteEpoch = mTileDeleteEpoch;
+			return lastTile;
+		}
+	}
+
+	std::atomic<Tile *> *seedGridCell = findSeedGridCell(key);
+	if(seedGridCell != nullptr){
+		Tile *gridSeed = seedGridCell->load(std::memory_order_relaxed);
+		if(gridSeed != nullptr) return findPoint(key, gridSeed);
+	}
 
+	return findPoint(key, (lastTile != nullptr)? lastTile : mNonBlankTiles.front());
+}
+
+Tile *CornerStitching::findPoint(const Cord &key, Tile *hint) const{
+
+	// If empty just return the blank tile, the hint is meaningless.
+	if(mNonBlankTiles.empty()){
+		return mCanvasSizeBlankTile;
+	}
+	if(hint == nullptr) return findPoint(key);
+
+	Tile *index = hint;
 	while(!(rec::isContained(index->getRectangle(), key))){
 
 		Rectangle indexRec = index->getRectangle();
@@ -598,11 +841,51 @@ Tile *CornerStitching::findPoint(const Cord &key) const{
 			}
 		}
 	}
-	
+
+	// remember the answer, the next query of this thread is likely nearby
+	lastPointFound = {mPlaneID, mTileDeleteEpoch, index};
+
+	// lazily fill the seed grid, the answer overlaps the cell since it includes key. Concurrent queries may race for the cell, any winner is fine
+	std::atomic<Tile *> *seedGridCell = findSeedGridCell(key);
+	if(seedGridCell != nullptr){
+		Tile *emptyCell = nullptr;
+		seedGridCell->compare_exchange_strong(emptyCell, index, std::memory_order_relaxed);
+	}
+
 	return index;
 }   
 
-void CornerStitching::findLineTile(Line &line, std::vector<LineTile> &positiveSide, std::vector<LineTile> &negativeSide){
+void CornerStitching::findPoints(const std::vector<Cord> &keys, std::vector<Tile *> &answers) const{
+	answers.assign(keys.size(), nullptr);
+
+	// sort the queries spatially so consecutive queries are close to each other
+	std::vector<mortonCode_t> codes(keys.size());
+	for(size_t i = 0; i < keys.size(); ++i){
+		codes[i] = mortonCode(keys[i]);
+	}
+	std::vector<size_t> order(keys.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(), [&codes](size_t a, size_t b){return codes[a] < codes[b];});
+
+	// each walk starts from the previous answer, unless that misses the key and the seed grid knows a tile of the key's own cell:
+	// on sparse batches consecutive keys can still be far apart, the grid seed bounds those walks
+	Tile *previousAnswer = nullptr;
+	for(size_t const &queryIdx : order){
+		const Cord &key = keys[queryIdx];
+		Tile *hint = previousAnswer;
+		if(hint == nullptr || !rec::isContained(hint->getRectangle(), key)){
+			std::atomic<Tile *> *seedGridCell = findSeedGridCell(key);
+			if(seedGridCell != nullptr){
+				Tile *gridSeed = seedGridCell->load(std::memory_order_relaxed);
+				if(gridSeed != nullptr) hint = gridSeed;
+			}
+		}
+		previousAnswer = findPoint(key, hint);
+		answers[queryIdx] = previousAnswer;
+	}
+}
+
+void CornerStitching::findLineTile(const Line &line, std::vector<LineTile> &positiveSide, std::vector<LineTile> &negativeSide) const{
 	
 	// throw exception if the line is out of canvas range
 	// fix bug 2024/04/12, allow the line to attatch to left border
@@ -622,14 +905,14 @@ void CornerStitching::findLineTile(Line &line, std::vector<LineTile> &positiveSi
 
 	// Find a seed to start, if empty just return the blank tile.
 	Tile *index;
-	if(mAllNonBlankTilesMap.empty()){
+	if(mNonBlankTiles.empty()){
 		// empty, return the blank tile
 		positiveSide.push_back(LineTile(line, mCanvasSizeBlankTile));
 		negativeSide.push_back(LineTile(line, mCanvasSizeBlankTile));
 
 		return;
 	}else{
-		index = mAllNonBlankTilesMap.begin()->second; 
+		index = mNonBlankTiles.front(); 
 	} 
 
 	if(line.getOrient() == orientation2D::HORIZONTAL){
@@ -817,62 +1100,41 @@ void CornerStitching::findLineTile(Line &line, std::vector<LineTile> &positiveSi
 }
 
 void CornerStitching::findTopNeighbors(Tile *centre, std::vector<Tile *> &neighbors) const{
-	if(centre == nullptr) return;
-	if(centre->rt == nullptr) return;
-
-	Tile *n = centre->rt;
-	while(n->getXLow() > centre->getXLow()){
-	
+	for(Tile *n : TileNeighborRange(centre, direction2D::UP)){
 		neighbors.push_back(n);
-		n = n->bl;
 	}
-	neighbors.push_back(n);
 }
 
 void CornerStitching::findDownNeighbors(Tile *centre, std::vector<Tile *> &neighbors) const{
-	if(centre == nullptr) return;
-	if(centre->lb == nullptr) return;
-
-	Tile *n = centre->lb;
-	while(n->getXHigh() < centre->getXHigh()){
+	for(Tile *n : TileNeighborRange(centre, direction2D::DOWN)){
 		neighbors.push_back(n);
-		n = n->tr;
 	}
-	neighbors.push_back(n);
 }
 
 void CornerStitching::findLeftNeighbors(Tile *centre, std::vector<Tile *> &neighbors) const{
-	if(centre == nullptr) return;
-	if(centre->bl == nullptr) return;
-
-	Tile *n = centre->bl;
-	while(n->getYHigh() < centre->getYHigh()){
+	for(Tile *n : TileNeighborRange(centre, direction2D::LEFT)){
 		neighbors.push_back(n);
-		n = n->rt;
 	}
-	neighbors.push_back(n);
 }
 
 void CornerStitching::findRightNeighbors(Tile *centre, std::vector<Tile *> &neighbors) const{
-	if(centre == nullptr) return;
-	if(centre->tr == nullptr) return;
-
-	Tile *n = centre->tr;
-	// the last neighbor is the first tile encountered whose lower y cord <= lower y cord of starting tile
-	while(n->getYLow() > centre->getYLow()){
+	for(Tile *n : TileNeighborRange(centre, direction2D::RIGHT)){
 		neighbors.push_back(n);
-		n = n->lb;
 	}
-	neighbors.push_back(n);
 }
 
 void CornerStitching::findAllNeighbors(Tile *centre, std::vector<Tile *> &neighbors) const{
-	if(centre == nullptr) return;
+	for(Tile *n : TileNeighborRange(centre)){
+		neighbors.push_back(n);
+	}
+}
+
+TileNeighborRange CornerStitching::neighbors(Tile *centre, direction2D side) const{
+	return TileNeighborRange(centre, side);
+}
 
-	findTopNeighbors(centre, neighbors);
-	findLeftNeighbors(centre, neighbors);
-	findDownNeighbors(centre, neighbors);
-	findRightNeighbors(centre, neighbors);
+TileNeighborRange CornerStitching::allNeighbors(Tile *centre) const{
+	return TileNeighborRange(centre);
 }
 
 bool CornerStitching::searchArea(Rectangle box) const{
@@ -897,7 +1159,7 @@ bool CornerStitching::searchArea(Rectangle box) const{
 		// Move down to the next tile touching the left edge of AOI
 		if(currentFind->getYLow() < 1) break;
 
-		currentFind = findPoint(Cord(rec::getXL(box), currentFind->getYLow() - 1));
+		currentFind = findNextTileDownLine(currentFind, rec::getXL(box));
 	}
 
 	return false;
@@ -927,7 +1189,7 @@ bool CornerStitching::searchArea(Rectangle box, Tile *someTile) const{
 		// Move down to the next tile touching the left edge of AOI
 		if(currentFind->getYLow() < 1) break;
 
-		currentFind = findPoint(Cord(rec::getXL(box), currentFind->getYLow() - 1));
+		currentFind = findNextTileDownLine(currentFind, rec::getXL(box));
 	}
 
 	return false;
@@ -953,14 +1215,176 @@ void CornerStitching::enumerateDirectedArea(Rectangle box, std::vector <Tile *>
 	// 	throw CSException("CORNERSTITCHING_03");
 	// }
 
-	// Use point-finding algo to locate the tile containin the upperleft corner of AOI
-	Tile *leftTouchTile = findPoint(Cord(rec::getXL(box), rec::getYH(box) - 1));
+	visitDirectedArea(box, [&allTiles](Tile *tile){
+		allTiles.push_back(tile);
+		return true;
+	});
+}
 
-	while(leftTouchTile->getYHigh() > rec::getYL(box)){
-		enumerateDirectedAreaRProcedure(box, allTiles, leftTouchTile);
-		if(leftTouchTile->getYLow() < 1) break;
-		// step to the next tile along the left edge
-		leftTouchTile = findPoint(Cord(rec::getXL(box), leftTouchTile->getYLow() - 1 ));
+void CornerStitching::collectBlankArea(const Rectangle &box, std::vector<Rectangle> &blankRectangles) const{
+	visitBlankArea(box, [&](Tile *blankTile){
+		Rectangle blankPart = blankTile->getRectangle();
+		boost::polygon::intersect(blankPart, box, false);
+		blankRectangles.push_back(blankPart);
+		return true;
+	});
+}
+
+area_t CornerStitching::calculateBlankArea(const Rectangle &box) const{
+	area_t blankArea = 0;
+	visitBlankArea(box, [&](Tile *blankTile){
+		Rectangle blankPart = blankTile->getRectangle();
+		boost::polygon::intersect(blankPart, box, false);
+		blankArea += rec::getArea(blankPart);
+		return true;
+	});
+	return blankArea;
+}
+
+void CornerStitching::collectBlankRegions(const Rectangle &box, std::vector<std::vector<Rectangle>> &blankRegions) const{
+	std::vector<Tile *> blankTiles;
+	std::vector<Rectangle> blankParts;
+	std::unordered_map<Tile *, int> tileIndex;
+	visitBlankArea(box, [&](Tile *blankTile){
+		Rectangle blankPart = blankTile->getRectangle();
+		boost::polygon::intersect(blankPart, box, false);
+		if(rec::getArea(blankPart) > 0){
+			tileIndex[blankTile] = blankTiles.size();
+			blankTiles.push_back(blankTile);
+			blankParts.push_back(blankPart);
+		}
+		return true;
+	});
+
+	// union the pieces of stitched blank tiles that share an edge of positive length inside box, pieces touching at a corner stay apart
+	std::vector<int> parent(blankTiles.size());
+	for(int i = 0; i < int(parent.size()); ++i) parent[i] = i;
+	auto findRoot = [&](int i){
+		while(parent[i] != i){
+			parent[i] = parent[parent[i]];
+			i = parent[i];
+		}
+		return i;
+	};
+
+	for(int i = 0; i < int(blankTiles.size()); ++i){
+		const Rectangle &part = blankParts[i];
+		for(Tile *const &neighbor : neighbors(blankTiles[i], direction2D::UP)){
+			std::unordered_map<Tile *, int>::const_iterator it = tileIndex.find(neighbor);
+			if(it == tileIndex.end()) continue;
+			const Rectangle &neighborPart = blankParts[it->second];
+			if(std::min(rec::getXH(part), rec::getXH(neighborPart)) > std::max(rec::getXL(part), rec::getXL(neighborPart))){
+				parent[findRoot(i)] = findRoot(it->second);
+			}
+		}
+		for(Tile *const &neighbor : neighbors(blankTiles[i], direction2D::RIGHT)){
+			std::unordered_map<Tile *, int>::const_iterator it = tileIndex.find(neighbor);
+			if(it == tileIndex.end()) continue;
+			const Rectangle &neighborPart = blankParts[it->second];
+			if(std::min(rec::getYH(part), rec::getYH(neighborPart)) > std::max(rec::getYL(part), rec::getYL(neighborPart))){
+				parent[findRoot(i)] = findRoot(it->second);
+			}
+		}
+	}
+
+	// key every region by its top edge and the right end of that edge, the order boost::polygon lists the polygons of a set in
+	std::unordered_map<int, int> rootRegion;
+	std::vector<std::pair<std::pair<len_t, len_t>, int>> regionKeys;
+	std::vector<std::vector<Rectangle>> regions;
+	for(int i = 0; i < int(blankParts.size()); ++i){
+		int root = findRoot(i);
+		std::unordered_map<int, int>::iterator it = rootRegion.find(root);
+		if(it == rootRegion.end()){
+			it = rootRegion.insert(std::make_pair(root, int(regions.size()))).first;
+			regions.push_back({});
+			regionKeys.push_back(std::make_pair(std::make_pair(rec::getYH(blankParts[i]), rec::getXH(blankParts[i])), it->second));
+		}
+		regions[it->second].push_back(blankParts[i]);
+		std::pair<len_t, len_t> &key = regionKeys[it->second].first;
+		key = std::max(key, std::make_pair(rec::getYH(blankParts[i]), rec::getXH(blankParts[i])));
+	}
+	std::sort(regionKeys.begin(), regionKeys.end());
+
+	blankRegions.reserve(blankRegions.size() + regions.size());
+	for(std::pair<std::pair<len_t, len_t>, int> const &regionKey : regionKeys){
+		blankRegions.push_back(std::move(regions[regionKey.second]));
+	}
+}
+
+Tile *CornerStitching::findNextTileRightLine(Tile *tile, len_t y) const{
+	// tr lies right beside the upper-right corner of tile, move down along its column until y is reached
+	Tile *nextTile = tile->tr;
+	while(nextTile->getYLow() > y){
+		nextTile = nextTile->lb;
+	}
+	return nextTile;
+}
+
+Rectangle CornerStitching::findBlankExtension(const Rectangle &sweepArea, direction2D direction) const{
+	len_t xl = rec::getXL(sweepArea), yl = rec::getYL(sweepArea), xh = rec::getXH(sweepArea), yh = rec::getYH(sweepArea);
+
+	// The front starts on the segment and leaves it one row (column) of tiles at a time: the tiles lying on the front are walked through
+	// their stitches, and while all of them are BLANK the front moves to the nearest far edge among them. The first nonblank tile stops it
+	switch (direction){
+	case direction2D::UP:{
+		Tile *rowStart = nullptr;
+		while(yl < yh){
+			rowStart = findPoint(Cord(xl, yl), rowStart);
+			len_t nextFront = yh;
+			for(Tile *tile = rowStart; ; tile = findNextTileRightLine(tile, yl)){
+				if(tile->getType() != tileType::BLANK) return Rectangle(xl, rec::getYL(sweepArea), xh, yl);
+				nextFront = std::min(nextFront, tile->getYHigh());
+				if(tile->getXHigh() >= xh) break;
+			}
+			yl = nextFront;
+		}
+		return sweepArea;
+	}
+	case direction2D::DOWN:{
+		Tile *rowStart = nullptr;
+		while(yh > yl){
+			rowStart = findPoint(Cord(xl, yh - 1), rowStart);
+			len_t nextFront = yl;
+			for(Tile *tile = rowStart; ; tile = findNextTileRightLine(tile, yh - 1)){
+				if(tile->getType() != tileType::BLANK) return Rectangle(xl, yh, xh, rec::getYH(sweepArea));
+				nextFront = std::max(nextFront, tile->getYLow());
+				if(tile->getXHigh() >= xh) break;
+			}
+			yh = nextFront;
+		}
+		return sweepArea;
+	}
+	case direction2D::RIGHT:{
+		Tile *columnStart = nullptr;
+		while(xl < xh){
+			columnStart = findPoint(Cord(xl, yh - 1), columnStart);
+			len_t nextFront = xh;
+			for(Tile *tile = columnStart; ; tile = findNextTileDownLine(tile, xl)){
+				if(tile->getType() != tileType::BLANK) return Rectangle(rec::getXL(sweepArea), yl, xl, yh);
+				nextFront = std::min(nextFront, tile->getXHigh());
+				if(tile->getYLow() <= yl) break;
+			}
+			xl = nextFront;
+		}
+		return sweepArea;
+	}
+	case direction2D::LEFT:{
+		Tile *columnStart = nullptr;
+		while(xh > xl){
+			columnStart = findPoint(Cord(xh - 1, yh - 1), columnStart);
+			len_t nextFront = xl;
+			for(Tile *tile = columnStart; ; tile = findNextTileDownLine(tile, xh - 1)){
+				if(tile->getType() != tileType::BLANK) return Rectangle(xh, yl, rec::getXH(sweepArea), yh);
+				nextFront = std::max(nextFront, tile->getXLow());
+				if(tile->getYLow() <= yl) break;
+			}
+			xh = nextFront;
+		}
+		return sweepArea;
+	}
+	default:
+		throw CSException("CORNERSTITCHING_28");
+		break;
 	}
 }
 
@@ -979,9 +1403,14 @@ Tile *CornerStitching::insertTile(const Tile &tile){
 	// 	throw CSException("CORNERSTITCHING_12");
 	// }
 
+	LocalInvariantGuard guard = {this, tile.getRectangle()};
+
+	// removals inside a batch may leave blank tiles that are not maximal strips, the insertion below relies on them
+	if(mBatchStripsBroken) mergeBatchBlanksHorizontally();
+
 	// Special case when inserting the first tile in the system
-	if(mAllNonBlankTilesMap.empty()){
-		Tile *tdown, *tup, *tleft, *tright;
+	if(mNonBlankTiles.empty()){
+		Tile *tdown = nullptr, *tup = nullptr, *tleft = nullptr, *tright = nullptr;
 
 		bool hasDownTile = (tile.getYLow() != mCanvasSizeBlankTile->getYLow());
 		bool hasUpTile = (tile.getYHigh() != mCanvasSizeBlankTile->getYHigh());
@@ -1030,8 +1459,12 @@ Tile *CornerStitching::insertTile(const Tile &tile){
 			if(hasDownTile) tdown->rt = newTile;
 		}
 
-		// push index into the map and exit
-		mAllNonBlankTilesMap[newTile->getLowerLeft()] = newTile;
+		// register the tiles and exit
+		registerTile(newTile);
+		if(hasDownTile) registerTile(tdown);
+		if(hasUpTile) registerTile(tup);
+		if(hasLeftTile) registerTile(tleft);
+		if(hasRightTile) registerTile(tright);
 		return newTile;
 	}
 
@@ -1045,7 +1478,7 @@ Tile *CornerStitching::insertTile(const Tile &tile){
 
 	bool tileTouchesSky = (tile.getYHigh() == mCanvasSizeBlankTile->getYHigh());
 	bool cleanTopCut = true;
-	Tile *origTop;
+	Tile *origTop = nullptr;
 	if(!tileTouchesSky){
 		origTop = findPoint(tile.getUpperLeft());
 		cleanTopCut = (origTop->getYLow() == tile.getYHigh());
@@ -1065,7 +1498,7 @@ Tile *CornerStitching::insertTile(const Tile &tile){
 	Tile *origBottom;
 	if(!tileTouchesGround){
 		Cord targetTileLL = tile.getLowerLeft();
-		origBottom = findPoint(Cord(targetTileLL.x(), (targetTileLL.y() - 1)));
+		origBottom = findPoint(Cord(targetTileLL.x(), (targetTileLL.y() - 1)), origTop);
 		cleanBottomCut = (origBottom->getYHigh() == tile.getYLow());
 	}
 
@@ -1088,6 +1521,7 @@ Tile *CornerStitching::insertTile(const Tile &tile){
 	// Merge assisting indexes
 	len_t leftMergeWidth = 0, rightMergeWidth = 0;
 	bool topMostMerge = true;
+	bool deferMerges = (mBatchDepth > 0);
 
 	while(true){
 
@@ -1099,6 +1533,7 @@ Tile *CornerStitching::insertTile(const Tile &tile){
 
 		// The middle tile that's completely within the new tile.
 		Tile *newMid = new Tile(tileType::BLANK, Cord(tileLeftBorder, splitTile->getYLow()), tile.getWidth(), splitTile->getHeight());
+		registerTile(newMid);
 
 		// initialize bl, tr pointer in case the left and right tile do not exist
 		newMid->bl = splitTile->bl;
@@ -1118,6 +1553,7 @@ Tile *CornerStitching::insertTile(const Tile &tile){
 
 		if(leftSplitNecessary){
 			Tile *newLeft = new Tile(tileType::BLANK, splitTile->getLowerLeft(), (tileLeftBorder - blankLeftBorder) ,splitTile->getHeight());
+			registerTile(newLeft);
 
 			newLeft->tr = newMid;
 			newLeft->bl = splitTile->bl;
@@ -1177,6 +1613,7 @@ Tile *CornerStitching::insertTile(const Tile &tile){
 		bool rightSplitNecessary = (tileRightBorder != blankRightBorder);
 		if(rightSplitNecessary){
 			Tile *newRight = new Tile(tileType::BLANK, newMid->getLowerRight(), (blankRightBorder - tileRightBorder), newMid->getHeight());
+			registerTile(newRight);
 
 			newRight->tr = splitTile->tr;
 			newRight->bl = newMid;
@@ -1231,6 +1668,12 @@ Tile *CornerStitching::insertTile(const Tile &tile){
 			}
 		}
 
+		// inside a batch the left and right remainders are not merged here, endBatch() merges them with the tiles above and below
+		if(deferMerges){
+			if(leftSplitNecessary) mBatchDirtyTiles.insert(newMid->bl);
+			if(rightSplitNecessary) mBatchDirtyTiles.insert(newMid->tr);
+		}
+
 		// link rt & lb pointers for newMid and modify the surrounding neighbor pointers 
 		bool rtModified = false;
 		for(int i = 0; i < topNeighbors.size(); ++i){
@@ -1282,7 +1725,7 @@ Tile *CornerStitching::insertTile(const Tile &tile){
 		}
 
 		bool leftNeedsMerge = ((leftMergeWidth > 0) && (leftMergeWidth == (tileLeftBorder - blankLeftBorder))) || initTopLeftMerge;
-		if(leftNeedsMerge){
+		if(leftNeedsMerge && (!deferMerges)){
 			Tile *mergeUp = newMid->bl->rt;
 			Tile *mergeDown = newMid->bl;
 			mergeTilesVertically(mergeUp, mergeDown);
@@ -1309,7 +1752,7 @@ Tile *CornerStitching::insertTile(const Tile &tile){
 		}
 		
 		bool rightNeedsMerge = ((rightMergeWidth > 0) && (rightMergeWidth == (blankRightBorder - tileRightBorder))) || initTopRightMerge;        
-		if(rightNeedsMerge){
+		if(rightNeedsMerge && (!deferMerges)){
 			Tile *mergeUp = newMid->tr->rt;
 			Tile *mergeDown = newMid->tr;
 			mergeTilesVertically(mergeUp, mergeDown);
@@ -1336,7 +1779,7 @@ Tile *CornerStitching::insertTile(const Tile &tile){
 			// detect & merge left bottom and the tiles below
 			bool lastDownLeftMerge = false;
 			Tile *lastBotLeftUp, *lastBotLeftDown;
-			if(leftSplitNecessary){
+			if(leftSplitNecessary && (!deferMerges)){
 				lastBotLeftUp = newMid->bl;
 				if(lastBotLeftUp->lb != nullptr){
 					lastBotLeftDown = lastBotLeftUp->lb;
@@ -1354,9 +1797,9 @@ Tile *CornerStitching::insertTile(const Tile &tile){
 			// detect & merge right bottom and the tiles below
 			bool lastDownRightmerge = false;
 			Tile *lastBotRightUp, *lastBotRightDown;
-			if(rightSplitNecessary){
+			if(rightSplitNecessary && (!deferMerges)){
 				// 08/06/2024 bug fix: lastBotRightUp finds incorrect tile, lastBotRightUp = newMid->tr does not point to the correct tile 
-				lastBotRightUp = findPoint(newMid->getLowerRight());
+				lastBotRightUp = findPoint(newMid->getLowerRight(), newMid);
 				if(lastBotRightUp->lb != nullptr){
 					lastBotRightDown = lastBotRightUp->lb;
 					bool sameWidth = (lastBotRightUp->getWidth() == lastBotRightDown->getWidth());
@@ -1372,16 +1815,15 @@ Tile *CornerStitching::insertTile(const Tile &tile){
 			}
 
 			// last step is to substitute newMid to the input tile
-			delete(oldSplitTile);
-			newMid->setType(tile.getType());
-			mAllNonBlankTilesMap[newMid->getLowerLeft()] = newMid;
+			freeTile(oldSplitTile);
+			retypeTile(newMid, tile.getType());
 			return newMid;
 		}
 
 		// the merging process has not yet hit the bottom tile, working downwards to next splitTile
-		delete(oldSplitTile);
+		freeTile(oldSplitTile);
 		topMostMerge = false;
-		splitTile = findPoint(Cord(tile.getXLow(), splitTileYLow - 1));
+		splitTile = findPoint(Cord(tile.getXLow(), splitTileYLow - 1), newMid);
 		splitTileYLow = splitTile->getYLow();
 		
    }
@@ -1391,26 +1833,37 @@ Tile *CornerStitching::insertTile(const Tile &tile){
 void CornerStitching::removeTile(Tile *tile){
 	// look up if the tile exist in the cornerStitching system
 	assert(tile != nullptr);
-	Cord tileLL = tile->getLowerLeft();
-	std::unordered_map<Cord, Tile*>::iterator deadTileIt = mAllNonBlankTilesMap.find(tileLL);
+	LocalInvariantGuard guard = {this, tile->getRectangle()};
+
+	// inside a batch the dead tile only turns BLANK, merging it with the blank tiles around is left to endBatch()
+	if(mBatchDepth > 0){
+		if(mNonBlankTiles.size() > 1){
+			retypeTile(tile, tileType::BLANK);
+			mBatchDirtyTiles.insert(tile);
+			mBatchStripsBroken = true;
+			return;
+		}
+		// removing the last non-blank tile frees its four neighbors, which must be the only (canonical) blank tiles left
+		canonicalizeBatch();
+	}
+
 	// there is no such index
-	// if(deadTileIt == mAllNonBlankTilesMap.end()){
+	// if((tile->mRegistryIndex < 0) || (tile->mRegistryIndex >= mNonBlankTiles.size())){
 	// 	throw (CSException("CORNERSTITCHING_17"));
 	// }
 	// // the index does not point to the tile to delete
-	// if(mAllNonBlankTilesMap[tileLL] != tile){
+	// if(mNonBlankTiles[tile->mRegistryIndex] != tile){
 	// 	throw (CSException("CORNERSTITCHING_18"));
 	// }	
 
 	// special case when there is only one noeBlank tile left in the cornerStitching system
-	if(mAllNonBlankTilesMap.size() == 1){
-		if(tile->rt != nullptr) delete(tile->rt);
-		if(tile->tr != nullptr) delete(tile->tr);
-		if(tile->bl != nullptr) delete(tile->bl);
-		if(tile->lb != nullptr) delete(tile->lb);
-
-		mAllNonBlankTilesMap.clear();
-		delete(tile);
+	if(mNonBlankTiles.size() == 1){
+		if(tile->rt != nullptr) freeTile(tile->rt);
+		if(tile->tr != nullptr) freeTile(tile->tr);
+		if(tile->bl != nullptr) freeTile(tile->bl);
+		if(tile->lb != nullptr) freeTile(tile->lb);
+
+		freeTile(tile);
 		return;
 	}
 
@@ -1419,10 +1872,9 @@ void CornerStitching::removeTile(Tile *tile){
 	
 	/*  STEP 1)
 		Change the type of the dead tile to tileType::BLANK
-		and remove the tile from mAllNonBlankTilesMap
+		and move the tile from mNonBlankTiles to mBlankTiles
 	*/
-	tile->setType(tileType::BLANK);
-	mAllNonBlankTilesMap.erase(deadTileIt);
+	retypeTile(tile, tileType::BLANK);
 
 	/*  STEP 2)
 		Use the neighbor-finding algorithm to search from top to bottom through all the tiles
@@ -1615,6 +2067,297 @@ void CornerStitching::removeTile(Tile *tile){
 
 }
 
+void CornerStitching::beginBatch(){
+	++mBatchDepth;
+}
+
+void CornerStitching::endBatch(){
+	if(mBatchDepth <= 0){
+		throw CSException("CORNERSTITCHING_27");
+	}
+
+	// the dirty tiles are freed through freeTile() while mBatchDepth > 0, so canonicalize before closing the batch
+	if(mBatchDepth == 1) canonicalizeBatch();
+	--mBatchDepth;
+}
+
+void CornerStitching::canonicalizeBatch(){
+	if(mBatchStripsBroken) mergeBatchBlanksHorizontally();
+	mergeBatchBlanksVertically();
+	mBatchDirtyTiles.clear();
+}
+
+void CornerStitching::mergeBatchBlanksHorizontally(){
+	std::vector<Tile *> toVisit(mBatchDirtyTiles.begin(), mBatchDirtyTiles.end());
+
+	while(!toVisit.empty()){
+		Tile *tile = toVisit.back();
+		toVisit.pop_back();
+		// the tile is already merged into another tile
+		if(mBatchDirtyTiles.find(tile) == mBatchDirtyTiles.end()) continue;
+		if(tile->getType() != tileType::BLANK) continue;
+
+		// look for a blank tile attatched to the left, then to the right of tile
+		Tile *mergeLeft = nullptr, *mergeRight = nullptr;
+		for(Tile *t : neighbors(tile, direction2D::LEFT)){
+			if(t->getType() == tileType::BLANK){
+				mergeLeft = t;
+				mergeRight = tile;
+				break;
+			}
+		}
+		if(mergeLeft == nullptr){
+			for(Tile *t : neighbors(tile, direction2D::RIGHT)){
+				if(t->getType() == tileType::BLANK){
+					mergeLeft = tile;
+					mergeRight = t;
+					break;
+				}
+			}
+		}
+		if(mergeLeft == nullptr) continue;
+
+		// cut both tiles to the y span they share, the pieces cut away (marked dirty by cutTileHorizontally) are visited later
+		len_t commonYLow = std::max(mergeLeft->getYLow(), mergeRight->getYLow());
+		len_t commonYHigh = std::min(mergeLeft->getYHigh(), mergeRight->getYHigh());
+		Tile *mergePair[2] = {mergeLeft, mergeRight};
+		for(Tile *&t : mergePair){
+			if(t->getYHigh() > commonYHigh){
+				Tile *upperPiece = t;
+				t = cutTileHorizontally(upperPiece, commonYHigh - upperPiece->getYLow());
+				toVisit.push_back(upperPiece);
+			}
+			if(t->getYLow() < commonYLow){
+				Tile *lowerPiece = cutTileHorizontally(t, commonYLow - t->getYLow());
+				toVisit.push_back(lowerPiece);
+			}
+		}
+
+		Tile *mergedTile = mergeTilesHorizontally(mergePair[0], mergePair[1]);
+		mBatchDirtyTiles.insert(mergedTile);
+		toVisit.push_back(mergedTile);
+	}
+
+	mBatchStripsBroken = false;
+}
+
+void CornerStitching::mergeBatchBlanksVertically(){
+	std::vector<Tile *> toVisit(mBatchDirtyTiles.begin(), mBatchDirtyTiles.end());
+
+	for(Tile *tile : toVisit){
+		// the tile is already merged into another tile
+		if(mBatchDirtyTiles.find(tile) == mBatchDirtyTiles.end()) continue;
+		if(tile->getType() != tileType::BLANK) continue;
+
+		// a blank tile with the same x span above (below) is exactly rt (lb)
+		Tile *upTile = tile->rt;
+		while((upTile != nullptr) && (upTile->getType() == tileType::BLANK) && 
+			(upTile->getXLow() == tile->getXLow()) && (upTile->getWidth() == tile->getWidth())){
+			tile = mergeTilesVertically(upTile, tile);
+			upTile = tile->rt;
+		}
+
+		Tile *downTile = tile->lb;
+		while((downTile != nullptr) && (downTile->getType() == tileType::BLANK) && 
+			(downTile->getXLow() == tile->getXLow()) && (downTile->getWidth() == tile->getWidth())){
+			tile = mergeTilesVertically(tile, downTile);
+			downTile = tile->lb;
+		}
+	}
+}
+
+void CornerStitching::bulkLoad(const std::vector<Tile> &prototypes, std::vector<Tile *> &loadedTiles){
+	if(!mNonBlankTiles.empty()){
+		throw CSException("CORNERSTITCHING_24");
+	}
+
+	loadedTiles.clear();
+	if(prototypes.empty()) return;
+
+	Rectangle canvasRectangle = mCanvasSizeBlankTile->getRectangle();
+	for(const Tile &prototype : prototypes){
+		if((prototype.getType() == tileType::BLANK) || (!rec::isContained(canvasRectangle, prototype.getRectangle()))){
+			throw CSException("CORNERSTITCHING_25");
+		}
+	}
+
+	// every tile of the plane (solid and blank), the stitches are resolved after all of them are built
+	std::vector<Tile *> allTiles;
+	allTiles.reserve(3 * prototypes.size() + 1);
+	loadedTiles.reserve(prototypes.size());
+	for(const Tile &prototype : prototypes){
+		Tile *solidTile = new Tile(prototype.getType(), prototype.getRectangle());
+		loadedTiles.push_back(solidTile);
+		allTiles.push_back(solidTile);
+	}
+
+	/*  STEP 1)
+		Sweep a horizontal line upwards over the y-events (bottom and top edges of solid tiles).
+		The sweep line holds the tiles crossing it, keyed by their left edge. At each event only the blank strips
+		touching a solid that starts or ends there change, they are closed and the gaps in that zone re-open as blank strips.
+		A re-opened gap that spans exactly the same x range as a closed blank continues that blank (vertical merge).
+	*/
+	std::vector<Tile *> solidsByBottom(loadedTiles);
+	std::sort(solidsByBottom.begin(), solidsByBottom.end(), [](Tile *a, Tile *b){return a->getYLow() < b->getYLow();});
+	std::vector<Tile *> solidsByTop(loadedTiles);
+	std::sort(solidsByTop.begin(), solidsByTop.end(), [](Tile *a, Tile *b){return a->getYHigh() < b->getYHigh();});
+
+	std::vector<len_t> eventYs = {0};
+	for(Tile *const &solidTile : loadedTiles){
+		eventYs.push_back(solidTile->getYLow());
+		if(solidTile->getYHigh() < mCanvasHeight) eventYs.push_back(solidTile->getYHigh());
+	}
+	std::sort(eventYs.begin(), eventYs.end());
+	eventYs.erase(std::unique(eventYs.begin(), eventYs.end()), eventYs.end());
+
+	// solidTile == nullptr marks a blank strip, whose bottom is yLow
+	struct SweepTile{
+		len_t xHigh;
+		len_t yLow;
+		Tile *solidTile;
+	};
+	std::map<len_t, SweepTile> sweepLine;
+
+	size_t bottomIdx = 0, topIdx = 0;
+	for(len_t const &eventY : eventYs){
+		std::vector<std::pair<len_t, len_t>> zones;
+		std::vector<Tile *> endingSolids, startingSolids;
+		while((topIdx < solidsByTop.size()) && (solidsByTop[topIdx]->getYHigh() == eventY)){
+			endingSolids.push_back(solidsByTop[topIdx++]);
+		}
+		while((bottomIdx < solidsByBottom.size()) && (solidsByBottom[bottomIdx]->getYLow() == eventY)){
+			startingSolids.push_back(solidsByBottom[bottomIdx++]);
+		}
+
+		if(eventY == 0) zones.push_back({0, mCanvasWidth});
+		for(Tile *const &solidTile : endingSolids) zones.push_back({solidTile->getXLow(), solidTile->getXHigh()});
+		for(Tile *const &solidTile : startingSolids) zones.push_back({solidTile->getXLow(), solidTile->getXHigh()});
+
+		// blank strips overlapping or touching the changed x ranges are closed at eventY, unless re-opened with the same x range
+		std::map<std::pair<len_t, len_t>, len_t> closingBlanks;
+		int changedRangeCount = zones.size();
+		for(int i = 0; i < changedRangeCount; ++i){
+			std::map<len_t, SweepTile>::iterator it = sweepLine.upper_bound(zones[i].first - 1);
+			if(it != sweepLine.begin()) --it;
+			for(; (it != sweepLine.end()) && (it->first <= zones[i].second); ++it){
+				if(it->second.solidTile == nullptr){
+					closingBlanks[{it->first, it->second.xHigh}] = it->second.yLow;
+				}
+			}
+		}
+		for(std::map<std::pair<len_t, len_t>, len_t>::iterator it = closingBlanks.begin(); it != closingBlanks.end(); ++it){
+			sweepLine.erase(it->first.first);
+			zones.push_back(it->first);
+		}
+
+		for(Tile *const &solidTile : endingSolids){
+			sweepLine.erase(solidTile->getXLow());
+		}
+
+		for(Tile *const &solidTile : startingSolids){
+			len_t xLow = solidTile->getXLow();
+			len_t xHigh = solidTile->getXHigh();
+			std::map<len_t, SweepTile>::iterator it = sweepLine.lower_bound(xLow);
+			bool overlapRight = (it != sweepLine.end()) && (it->first < xHigh);
+			bool overlapLeft = (it != sweepLine.begin()) && (std::prev(it)->second.xHigh > xLow);
+			if(overlapRight || overlapLeft){
+				throw CSException("CORNERSTITCHING_26");
+			}
+			sweepLine[xLow] = {xHigh, eventY, solidTile};
+		}
+
+		// merge the zones into disjoint x ranges, they are bounded by solids or the canvas so the gaps inside are maximal
+		std::sort(zones.begin(), zones.end());
+		std::vector<std::pair<len_t, len_t>> mergedZones;
+		for(std::pair<len_t, len_t> const &zone : zones){
+			if((!mergedZones.empty()) && (zone.first <= mergedZones.back().second)){
+				mergedZones.back().second = std::max(mergedZones.back().second, zone.second);
+			}else{
+				mergedZones.push_back(zone);
+			}
+		}
+
+		for(std::pair<len_t, len_t> const &zone : mergedZones){
+			std::vector<std::pair<len_t, len_t>> gaps;
+			len_t cursor = zone.first;
+			for(std::map<len_t, SweepTile>::iterator it = sweepLine.lower_bound(zone.first); (it != sweepLine.end()) && (it->first < zone.second); ++it){
+				if(it->first > cursor) gaps.push_back({cursor, it->first});
+				cursor = it->second.xHigh;
+			}
+			if(cursor < zone.second) gaps.push_back({cursor, zone.second});
+
+			for(std::pair<len_t, len_t> const &gap : gaps){
+				len_t blankYLow = eventY;
+				std::map<std::pair<len_t, len_t>, len_t>::iterator closeIt = closingBlanks.find(gap);
+				if(closeIt != closingBlanks.end()){
+					blankYLow = closeIt->second;
+					closingBlanks.erase(closeIt);
+				}
+				sweepLine[gap.first] = {gap.second, blankYLow, nullptr};
+			}
+		}
+
+		for(std::map<std::pair<len_t, len_t>, len_t>::iterator it = closingBlanks.begin(); it != closingBlanks.end(); ++it){
+			len_t xLow = it->first.first, xHigh = it->first.second, yLow = it->second;
+			allTiles.push_back(new Tile(tileType::BLANK, Cord(xLow, yLow), xHigh - xLow, eventY - yLow));
+		}
+	}
+
+	// blank strips still crossing the sweep line reach the top of canvas
+	for(std::map<len_t, SweepTile>::iterator it = sweepLine.begin(); it != sweepLine.end(); ++it){
+		if(it->second.solidTile != nullptr) continue;
+		len_t xLow = it->first, xHigh = it->second.xHigh, yLow = it->second.yLow;
+		allTiles.push_back(new Tile(tileType::BLANK, Cord(xLow, yLow), xHigh - xLow, mCanvasHeight - yLow));
+	}
+
+	/*  STEP 2)
+		Resolve the four stitches of every tile. Tiles sharing the same edge coordinate are disjoint along the other axis,
+		so the tile holding the stitch point is the last one (in sorted order) that starts before the point.
+	*/
+	typedef std::pair<std::pair<len_t, len_t>, Tile *> KeyedTile;
+	std::vector<KeyedTile> byTopEdge, byBottomEdge, byLeftEdge, byRightEdge;
+	byTopEdge.reserve(allTiles.size());
+	byBottomEdge.reserve(allTiles.size());
+	byLeftEdge.reserve(allTiles.size());
+	byRightEdge.reserve(allTiles.size());
+	for(Tile *const &tile : allTiles){
+		byTopEdge.push_back({{tile->getYHigh(), tile->getXLow()}, tile});
+		byBottomEdge.push_back({{tile->getYLow(), tile->getXLow()}, tile});
+		byLeftEdge.push_back({{tile->getXLow(), tile->getYLow()}, tile});
+		byRightEdge.push_back({{tile->getXHigh(), tile->getYLow()}, tile});
+	}
+	std::sort(byTopEdge.begin(), byTopEdge.end());
+	std::sort(byBottomEdge.begin(), byBottomEdge.end());
+	std::sort(byLeftEdge.begin(), byLeftEdge.end());
+	std::sort(byRightEdge.begin(), byRightEdge.end());
+
+	// find the tile whose edge lies on edgeCord and spans over alongCord
+	auto findStitch = [](const std::vector<KeyedTile> &sortedTiles, len_t edgeCord, len_t alongCord) -> Tile *{
+		std::vector<KeyedTile>::const_iterator it = std::upper_bound(sortedTiles.begin(), sortedTiles.end(), 
+			KeyedTile({edgeCord, alongCord}, nullptr), [](const KeyedTile &a, const KeyedTile &b){return a.first < b.first;});
+		assert(it != sortedTiles.begin());
+		--it;
+		assert(it->first.first == edgeCord);
+		return it->second;
+	};
+
+	for(Tile *const &tile : allTiles){
+		tile->rt = (tile->getYHigh() == mCanvasHeight)? nullptr : findStitch(byBottomEdge, tile->getYHigh(), tile->getXHigh() - 1);
+		tile->tr = (tile->getXHigh() == mCanvasWidth)? nullptr : findStitch(byLeftEdge, tile->getXHigh(), tile->getYHigh() - 1);
+		tile->bl = (tile->getXLow() == 0)? nullptr : findStitch(byRightEdge, tile->getXLow(), tile->getYLow());
+		tile->lb = (tile->getYLow() == 0)? nullptr : findStitch(byTopEdge, tile->getYLow(), tile->getXLow());
+	}
+
+	mNonBlankTiles.reserve(loadedTiles.size());
+	for(Tile *const &solidTile : loadedTiles){
+		registerTile(solidTile);
+	}
+	mBlankTiles.reserve(allTiles.size() - loadedTiles.size());
+	for(Tile *const &tile : allTiles){
+		if(tile->getType() == tileType::BLANK) registerTile(tile);
+	}
+}
+
 Tile *CornerStitching::cutTileHorizontally(Tile *origTop, len_t newDownHeight){
 
 	// check if the cut is valid on the Y axis
@@ -1679,6 +2422,15 @@ Tile *CornerStitching::cutTileHorizontally(Tile *origTop, len_t newDownHeight){
 	origTop->setLowerLeft(newDown->getUpperLeft());
 	origTop->setHeight(origTop->getHeight() - newDownHeight);
 	origTop->lb = newDown;
+	reseedGrid(newDown->getRectangle(), origTop, newDown);
+
+	// keep the registries up to date
+	registerTile(newDown);
+	if((origTop->getType() == tileType::BLANK) && (mBatchDepth > 0)){
+		// inside a batch both pieces may be vertically mergeable with blank tiles whose merging is deferred
+		mBatchDirtyTiles.insert(origTop);
+		mBatchDirtyTiles.insert(newDown);
+	}
 
 	return newDown;
 }
@@ -1745,6 +2497,10 @@ Tile *CornerStitching::cutTileVertically(Tile *origRight, len_t newLeftWidth){
 	origRight->setLowerLeft(newLeft->getLowerRight());
 	origRight->setWidth(origRight->getWidth() - newLeftWidth);
 	origRight->bl = newLeft;
+	reseedGrid(newLeft->getRectangle(), origRight, newLeft);
+
+	// keep the registries up to date
+	registerTile(newLeft);
 
 	return newLeft;
 	
@@ -1790,11 +2546,12 @@ Tile *CornerStitching::mergeTilesVertically(Tile *mergeUp, Tile *mergeDown){
 	
 	mergeUp->bl = mergeDown->bl;
 	mergeUp->lb = mergeDown->lb;
-	
+
 	mergeUp->setLowerLeft(mergeDown->getLowerLeft());
 	mergeUp->setHeight(mergeUp->getHeight() + mergeDown->getHeight());
 	
-	delete(mergeDown);
+	// freeTile() also takes mergeDown out of its registry
+	freeTile(mergeDown);
 	return mergeUp;
 }
 
@@ -1842,7 +2599,7 @@ Tile *CornerStitching::mergeTilesHorizontally(Tile *mergeLeft, Tile *mergeRight)
 
 	mergeLeft->setWidth(mergeLeft->getWidth() + mergeRight->getWidth());
 
-	delete(mergeRight);
+	freeTile(mergeRight);
 	return mergeLeft;
 
 }
@@ -1988,7 +2745,161 @@ bool CornerStitching::conductSelfTest() const{
 	if(!pointerAttatched){
 		std::cout << "Fail pointer attatch Test " << *tile1 << " " << *tile2 << std::endl;
 	}
-	return (blankMergeTest && pointerAttatched);
+
+	// the tiles reachable through the stitches must be exactly the registered ones
+	bool registryMatched = true;
+	if(!mNonBlankTiles.empty()){
+		std::unordered_set<Tile *> reachedTiles;
+		collectAllTilesDFS(mNonBlankTiles.front(), reachedTiles);
+		registryMatched = (reachedTiles.size() == mNonBlankTiles.size() + mBlankTiles.size());
+		for(Tile *const &tile : reachedTiles){
+			const std::vector<Tile *> &registry = (tile->getType() == tileType::BLANK)? mBlankTiles : mNonBlankTiles;
+			if((tile->mRegistryIndex < 0) || (tile->mRegistryIndex >= int(registry.size())) || (registry[tile->mRegistryIndex] != tile)){
+				std::cout << "Fail registry Test " << *tile << std::endl;
+				registryMatched = false;
+				break;
+			}
+		}
+	}
+	return (blankMergeTest && pointerAttatched && registryMatched);
+}
+
+bool CornerStitching::checkTileInvariants(Tile *tile, bool checkStrips, Tile *&tile1, Tile *&tile2) const{
+	tile1 = tile;
+	tile2 = nullptr;
+	len_t xLow = tile->getXLow(), xHigh = tile->getXHigh();
+	len_t yLow = tile->getYLow(), yHigh = tile->getYHigh();
+	bool tileBlank = (tile->getType() == tileType::BLANK);
+
+	if((xLow < 0) || (yLow < 0) || (xHigh > mCanvasWidth) || (yHigh > mCanvasHeight) || (xLow >= xHigh) || (yLow >= yHigh)) return false;
+
+	// a nonblank tile must be registered in mNonBlankTiles, a blank one in mBlankTiles
+	const std::vector<Tile *> &registry = tileBlank? mBlankTiles : mNonBlankTiles;
+	bool registered = (tile->mRegistryIndex >= 0) && (tile->mRegistryIndex < int(registry.size())) && (registry[tile->mRegistryIndex] == tile);
+	if(!registered) return false;
+
+	// a stitch is nullptr only on the canvas border
+	if((tile->rt == nullptr) != (yHigh == mCanvasHeight)) return false;
+	if((tile->tr == nullptr) != (xHigh == mCanvasWidth)) return false;
+	if((tile->lb == nullptr) != (yLow == 0)) return false;
+	if((tile->bl == nullptr) != (xLow == 0)) return false;
+
+	// Walk the neighbors of each side from the stitch of tile: rt & tr must include the upper-right corner of tile, lb & bl the lower-left corner,
+	// consecutive neighbors must abut each other until the side is covered, and a neighbor whose stitch falls on tile must point back to tile
+
+	// top neighbors, right to left, their lb points to tile if their lower-left corner sits on tile
+	if(tile->rt != nullptr){
+		Tile *neighbor = tile->rt;
+		tile2 = neighbor;
+		if((neighbor->getXLow() >= xHigh) || (neighbor->getXHigh() < xHigh)) return false;
+		while(true){
+			tile2 = neighbor;
+			if(neighbor->getYLow() != yHigh) return false;
+			if((neighbor->getXLow() >= xLow) != (neighbor->lb == tile)) return false;
+			if(neighbor->getXLow() <= xLow) break;
+			Tile *next = neighbor->bl;
+			if((next == nullptr) || (next->getXHigh() != neighbor->getXLow())) return false;
+			neighbor = next;
+		}
+	}
+
+	// right neighbors, top to bottom, their bl points to tile if their lower-left corner sits on tile
+	if(tile->tr != nullptr){
+		Tile *neighbor = tile->tr;
+		tile2 = neighbor;
+		if((neighbor->getYLow() >= yHigh) || (neighbor->getYHigh() < yHigh)) return false;
+		while(true){
+			tile2 = neighbor;
+			if(neighbor->getXLow() != xHigh) return false;
+			if((neighbor->getYLow() >= yLow) != (neighbor->bl == tile)) return false;
+			if(checkStrips && tileBlank && (neighbor->getType() == tileType::BLANK)) return false;
+			if(neighbor->getYLow() <= yLow) break;
+			Tile *next = neighbor->lb;
+			if((next == nullptr) || (next->getYHigh() != neighbor->getYLow())) return false;
+			neighbor = next;
+		}
+	}
+
+	// down neighbors, left to right, their rt points to tile if their upper-right corner sits under tile
+	if(tile->lb != nullptr){
+		Tile *neighbor = tile->lb;
+		tile2 = neighbor;
+		if((neighbor->getXLow() > xLow) || (neighbor->getXHigh() <= xLow)) return false;
+		while(true){
+			tile2 = neighbor;
+			if(neighbor->getYHigh() != yLow) return false;
+			if((neighbor->getXHigh() <= xHigh) != (neighbor->rt == tile)) return false;
+			if(neighbor->getXHigh() >= xHigh) break;
+			Tile *next = neighbor->tr;
+			if((next == nullptr) || (next->getXLow() != neighbor->getXHigh())) return false;
+			neighbor = next;
+		}
+	}
+
+	// left neighbors, bottom to top, their tr points to tile if their upper-right corner sits beside tile
+	if(tile->bl != nullptr){
+		Tile *neighbor = tile->bl;
+		tile2 = neighbor;
+		if((neighbor->getYLow() > yLow) || (neighbor->getYHigh() <= yLow)) return false;
+		while(true){
+			tile2 = neighbor;
+			if(neighbor->getXHigh() != xLow) return false;
+			if((neighbor->getYHigh() <= yHigh) != (neighbor->tr == tile)) return false;
+			if(checkStrips && tileBlank && (neighbor->getType() == tileType::BLANK)) return false;
+			if(neighbor->getYHigh() >= yHigh) break;
+			Tile *next = neighbor->rt;
+			if((next == nullptr) || (next->getYLow() != neighbor->getYHigh())) return false;
+			neighbor = next;
+		}
+	}
+
+	// a maximal strip cannot be merged with a BLANK tile of the same x span above or below
+	if(checkStrips && tileBlank){
+		for(Tile *vertical : {tile->rt, tile->lb}){
+			tile2 = vertical;
+			if((vertical != nullptr) && (vertical->getType() == tileType::BLANK) && (vertical->getXLow() == xLow) && (vertical->getXHigh() == xHigh)) return false;
+		}
+	}
+
+	tile2 = nullptr;
+	return true;
+}
+
+bool CornerStitching::checkLocalInvariants(const Rectangle &area, Tile *&tile1, Tile *&tile2) const{
+	tile1 = nullptr;
+	tile2 = nullptr;
+
+	// grow area by 1 (within the canvas) so the tiles touching its edges are collected as well
+	Rectangle grownArea(std::max(rec::getXL(area) - 1, len_t(0)), std::max(rec::getYL(area) - 1, len_t(0)),
+						std::min(rec::getXH(area) + 1, mCanvasWidth), std::min(rec::getYH(area) + 1, mCanvasHeight));
+	if((rec::getXL(grownArea) >= rec::getXH(grownArea)) || (rec::getYL(grownArea) >= rec::getYH(grownArea))) return true;
+
+	std::vector<Tile *> localTiles;
+	auto collect = [&](Tile *tile){
+		localTiles.push_back(tile);
+		return true;
+	};
+	visitAreaTiles(grownArea, collect, false);
+	visitAreaTiles(grownArea, collect, true);
+
+	// blank tiles are only maximal strips outside of batches
+	bool checkStrips = (mBatchDepth == 0);
+	for(Tile *const &tile : localTiles){
+		if(!checkTileInvariants(tile, checkStrips, tile1, tile2)) return false;
+	}
+	return true;
+}
+
+void CornerStitching::debugCheckLocalInvariants([[maybe_unused]] const Rectangle &area) const{
+#ifdef CORNERSTITCHING_LOCAL_CHECK
+	Tile *tile1, *tile2;
+	if(!checkLocalInvariants(area, tile1, tile2)){
+		std::cout << "Fail local invariant check " << *tile1;
+		if(tile2 != nullptr) std::cout << " " << *tile2;
+		std::cout << std::endl;
+		throw CSException("CORNERSTITCHING_30");
+	}
+#endif
 }
 
 Tile* CornerStitching::generalSplitTile(Tile* originalTile, Rectangle newRect, std::vector<Tile*>& newNeighbors){    
@@ -1998,6 +2909,7 @@ Tile* CornerStitching::generalSplitTile(Tile* originalTile, Rectangle newRect, s
         std::cerr << "new Tile not contained in original Tile\n";
         return NULL;
     }
+    LocalInvariantGuard guard = {this, originalRect};
 
     // find neighbors
     std::vector<Tile*> topNeighbors, bottomNeighbors, leftNeighbors, rightNeighbors;
@@ -2044,29 +2956,30 @@ Tile* CornerStitching::generalSplitTile(Tile* originalTile, Rectangle newRect, s
         // adjust the ptrs of left, top, right neighbors
         // left
         for (Tile* leftNeighbor: leftNeighbors){
-            int neighborYh = leftNeighbor->getYHigh();
+            len_t neighborYh = leftNeighbor->getYHigh();
             if (newTopTile->getYLow() < neighborYh && neighborYh <= newTopTile->getYHigh()){
                 leftNeighbor->tr = newTopTile;
             }
         }
         // top
         for (Tile* topNeighbor: topNeighbors){
-            int neighborXl = topNeighbor->getXLow();
+            len_t neighborXl = topNeighbor->getXLow();
             if (newTopTile->getXLow() <= neighborXl && neighborXl < newTopTile->getXHigh()){
                 topNeighbor->lb = newTopTile;
             }
         }
         // right
         for (Tile* rightNeighbor: rightNeighbors){
-            int neighborYl = rightNeighbor->getYLow();
+            len_t neighborYl = rightNeighbor->getYLow();
             if (newTopTile->getYLow() <= neighborYl && neighborYl < newTopTile->getYHigh()){
                 rightNeighbor->bl = newTopTile;
             }
         }
 
         // adjust x, y, width, height of old tile
-        int newHeight = originalTile->getHeight() - newTopTile->getHeight();
+        len_t newHeight = originalTile->getHeight() - newTopTile->getHeight();
         originalTile->setHeight(newHeight);
+		reseedGrid(newTopTile->getRectangle(), originalTile, newTopTile);
 
         // add newTile to neighbors
 		newNeighbors.push_back(newTopTile);
@@ -2078,13 +2991,8 @@ Tile* CornerStitching::generalSplitTile(Tile* originalTile, Rectangle newRect, s
 		// update shape of centerRect
 		gtl::yh(centerRect, rec::getYL(topRect));
 
-		// update mAllNonBlankTilesMap
-		if (originalTile->getType() != tileType::BLANK){
-			Cord topLL = newTopTile->getLowerLeft();
-			Cord bottomLL = originalTile->getLowerLeft();
-			this->mAllNonBlankTilesMap[topLL] = newTopTile;
-			this->mAllNonBlankTilesMap[bottomLL] = originalTile;
-		}
+		// update the registries
+		registerTile(newTopTile);
     }
 
     // split bottom if necessary
@@ -2125,30 +3033,31 @@ Tile* CornerStitching::generalSplitTile(Tile* originalTile, Rectangle newRect, s
         // adjust the ptrs of left, bottom, right neighbors
         // left
         for (Tile* leftNeighbor: leftNeighbors){
-            int neighborYh = leftNeighbor->getYHigh();
+            len_t neighborYh = leftNeighbor->getYHigh();
             if (newBottomTile->getYLow() < neighborYh && neighborYh <= newBottomTile->getYHigh()){
                 leftNeighbor->tr = newBottomTile;
             }
         }
         // bottom
         for (Tile* bottomNeighbor: bottomNeighbors){
-            int neighborXh = bottomNeighbor->getXHigh();
+            len_t neighborXh = bottomNeighbor->getXHigh();
             if (newBottomTile->getXLow() < neighborXh && neighborXh <= newBottomTile->getXHigh()){
                 bottomNeighbor->rt = newBottomTile;
             }
         }
         // right
         for (Tile* rightNeighbor: rightNeighbors){
-            int neighborYl = rightNeighbor->getYLow();
+            len_t neighborYl = rightNeighbor->getYLow();
             if (newBottomTile->getYLow() <= neighborYl && neighborYl < newBottomTile->getYHigh()){
                 rightNeighbor->bl = newBottomTile;
             }
         }
 
         // adjust x, y, width, height of old tile
-        int newHeight = originalTile->getHeight() - newBottomTile->getHeight();
+        len_t newHeight = originalTile->getHeight() - newBottomTile->getHeight();
         originalTile->setHeight(newHeight);
         originalTile->setLowerLeft(newBottomTile->getUpperLeft());
+		reseedGrid(newBottomTile->getRectangle(), originalTile, newBottomTile);
 
 		// add tile to new neighbors
 		newNeighbors.push_back(newBottomTile);
@@ -2160,13 +3069,8 @@ Tile* CornerStitching::generalSplitTile(Tile* originalTile, Rectangle newRect, s
 		// update shape of center rect
 		gtl::yl(centerRect, rec::getYH(bottomRect));
 		
-		// update mAllNonBlankTilesMap
-		if (originalTile->getType() != tileType::BLANK){
-			Cord bottomLL = newBottomTile->getLowerLeft();
-			Cord topLL = originalTile->getLowerLeft();
-			this->mAllNonBlankTilesMap[bottomLL] = newBottomTile;
-			this->mAllNonBlankTilesMap[topLL] = originalTile;
-		}
+		// update the registries
+		registerTile(newBottomTile);
     }
 
     // split right if necessary
@@ -2207,29 +3111,30 @@ Tile* CornerStitching::generalSplitTile(Tile* originalTile, Rectangle newRect, s
         // adjust the ptrs of top, right, bottom neighbors
         // top
         for (Tile* topNeighbor: topNeighbors){
-            int neighborXl = topNeighbor->getXLow();
+            len_t neighborXl = topNeighbor->getXLow();
             if (newRightTile->getXLow() <= neighborXl && neighborXl < newRightTile->getXHigh()){
                 topNeighbor->lb = newRightTile;
             }
         }
         // right
         for (Tile* rightNeighbor: rightNeighbors){
-            int neighborYl = rightNeighbor->getYLow();
+            len_t neighborYl = rightNeighbor->getYLow();
             if (newRightTile->getYLow() <= neighborYl && neighborYl < newRightTile->getYHigh()){
                 rightNeighbor->bl = newRightTile;
             }
         }
         // bottom
         for (Tile* bottomNeighbor: bottomNeighbors){
-            int neighborXh = bottomNeighbor->getXHigh();
+            len_t neighborXh = bottomNeighbor->getXHigh();
             if (newRightTile->getXLow() < neighborXh && neighborXh <= newRightTile->getXHigh()){
                 bottomNeighbor->rt = newRightTile;
             }
         }
 
         // adjust x,y,width,height of old tile;
-        int newWidth = originalTile->getWidth() - newRightTile->getWidth();
+        len_t newWidth = originalTile->getWidth() - newRightTile->getWidth();
         originalTile->setWidth(newWidth);
+		reseedGrid(newRightTile->getRectangle(), originalTile, newRightTile);
 
         // add newTile to neighbors
 		newNeighbors.push_back(newRightTile);
@@ -2237,13 +3142,8 @@ Tile* CornerStitching::generalSplitTile(Tile* originalTile, Rectangle newRect, s
 		// update shape of centerRect
 		gtl::xh(centerRect, rec::getXL(rightRect));
 		
-		// update mAllNonBlankTilesMap
-		if (originalTile->getType() != tileType::BLANK){
-			Cord rightLL = newRightTile->getLowerLeft();
-			Cord leftLL = originalTile->getLowerLeft();
-			this->mAllNonBlankTilesMap[rightLL] = newRightTile;
-			this->mAllNonBlankTilesMap[leftLL] = originalTile;
-		}
+		// update the registries
+		registerTile(newRightTile);
     }
 
     // split left if necessary
@@ -2284,30 +3184,31 @@ Tile* CornerStitching::generalSplitTile(Tile* originalTile, Rectangle newRect, s
         // adjust the ptrs of bottom, left, top neighbors
         // bottom
         for (Tile* bottomNeighbor: bottomNeighbors){
-            int neighborXh = bottomNeighbor->getXHigh();
+            len_t neighborXh = bottomNeighbor->getXHigh();
             if (newLeftTile->getXLow() < neighborXh && neighborXh <= newLeftTile->getXHigh()){
                 bottomNeighbor->rt = newLeftTile;
             }
         }
         // left
         for (Tile* leftNeighbor: leftNeighbors){
-            int neighborYh = leftNeighbor->getYHigh();
+            len_t neighborYh = leftNeighbor->getYHigh();
             if (newLeftTile->getYLow() < neighborYh && neighborYh <= newLeftTile->getYHigh()){
                 leftNeighbor->tr = newLeftTile;
             }
         }
         // top
         for (Tile* topNeighbor: topNeighbors){
-            int neighborXl = topNeighbor->getXLow();
+            len_t neighborXl = topNeighbor->getXLow();
             if (newLeftTile->getXLow() <= neighborXl && neighborXl < newLeftTile->getXHigh()){
                 topNeighbor->lb = newLeftTile;
             }
         }
 
         // adjust x,y,width,height of old tile;
-        int newWidth = originalTile->getWidth() - newLeftTile->getWidth();
+        len_t newWidth = originalTile->getWidth() - newLeftTile->getWidth();
         originalTile->setWidth(newWidth);
         originalTile->setLowerLeft(newLeftTile->getLowerRight());
+		reseedGrid(newLeftTile->getRectangle(), originalTile, newLeftTile);
 
         // add newTile to neighbors
 		newNeighbors.push_back(newLeftTile);
@@ -2315,13 +3216,8 @@ Tile* CornerStitching::generalSplitTile(Tile* originalTile, Rectangle newRect, s
 		// update shape of center rect
 		gtl::xl(centerRect, rec::getXH(newLeft));
 		
-		// update mAllNonBlankTilesMap
-		if (originalTile->getType() != tileType::BLANK){
-			Cord leftLL = newLeftTile->getLowerLeft();
-			Cord rightLL = originalTile->getLowerLeft();
-			this->mAllNonBlankTilesMap[leftLL] = newLeftTile;
-			this->mAllNonBlankTilesMap[rightLL] = originalTile;
-		}
+		// update the registries
+		registerTile(newLeftTile);
     }
 
 	assert(gtl::equivalence(centerRect, originalTile->getRectangle()));
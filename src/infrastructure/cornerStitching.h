@@ -3,12 +3,18 @@
 
 #include <unordered_map>
 #include <unordered_set>
+#include <map>
+#include <atomic>
 
 #include "units.h"
 #include "cord.h"
 #include "tile.h"
 #include "lineTile.h"
+#include "tileNeighbor.h"
 
+// All queries (point-finding, findLineTile, area enumeration/search and the neighbor finders) are const and reentrant:
+// any number of threads may query the same plane concurrently, as long as no thread modifies it meanwhile.
+// The only state queries write is the per-thread point-finding memory and the atomic seed grid cells
 class CornerStitching {
 // private:
 public:
@@ -16,7 +22,55 @@ public:
     len_t mCanvasWidth, mCanvasHeight;
     Tile *mCanvasSizeBlankTile;
 
-    std::unordered_map <Cord, Tile*> mAllNonBlankTilesMap;
+    // unique identity of the plane and a counter bumped whenever a tile is freed, the last RECENTLY_FREED_TILE_COUNT freed tiles are kept
+    // in mRecentlyFreedTiles (slot epoch % RECENTLY_FREED_TILE_COUNT). A remembered Tile pointer (eg. last point-finding answer) taken a
+    // few frees ago is still alive unless it is one of them, see isTileAliveSince()
+    static const int RECENTLY_FREED_TILE_COUNT = 16;
+    unsigned long long mPlaneID;
+    unsigned long long mTileDeleteEpoch;
+    Tile *mRecentlyFreedTiles[RECENTLY_FREED_TILE_COUNT];
+
+    // nesting depth of beginBatch(), and the blank tiles that may violate the maximal-horizontal-strip invariant while batching
+    // mBatchStripsBroken is set when a removal leaves blank tiles that are not horizontally maximal, insertTile() requires them merged
+    int mBatchDepth;
+    bool mBatchStripsBroken;
+    std::unordered_set<Tile *> mBatchDirtyTiles;
+
+    // every nonblank tile of the plane in no particular order, each tile keeps its own position (Tile::mRegistryIndex)
+    // so registering and unregistering a tile are O(1) without hashing
+    std::vector<Tile *> mNonBlankTiles;
+    // same for every BLANK tile of the plane, the index of empty space. Both registries share Tile::mRegistryIndex, a tile sits in the one
+    // matching its type. mCanvasSizeBlankTile (the only tile of an empty plane) is never registered
+    std::vector<Tile *> mBlankTiles;
+
+    // tiles relocated by relayoutTiles() live inside arenas (contiguous buffers) instead of separate heap blocks
+    // mTileArenas maps the first tile of each arena to (capacity, count of tiles still alive inside), an arena is released once empty
+    std::map<Tile *, std::pair<size_t, size_t>> mTileArenas;
+
+    // optional coarse grid over the canvas, each cell remembers a tile overlapping it (or nullptr) as the seed of findPoint
+    // cells are filled lazily by findPoint and kept valid on tile split and free, an empty grid means the grid is disabled
+    // cells are atomic as concurrent queries may fill the same cell
+    len_t mSeedGridCellWidth, mSeedGridCellHeight;
+    int mSeedGridColumns, mSeedGridRows;
+    mutable std::vector<std::atomic<Tile *>> mSeedGrid;
+
+    // merge the dirty blank tiles (cut them if necessary) with blank tiles on their left and right, until all blank tiles are horizontally maximal
+    void mergeBatchBlanksHorizontally();
+    // merge the dirty blank tiles with the blank tiles above and below when they share the same x span
+    void mergeBatchBlanksVertically();
+    // restore the maximal-horizontal-strip invariant around all dirty tiles of the batch
+    void canonicalizeBatch();
+
+    // whether tile, alive at epoch tileEpoch of this plane, is still alive. False if too many tiles were freed since to tell
+    bool isTileAliveSince(const Tile *tile, unsigned long long tileEpoch) const;
+
+    // (re)build the seed grid with cellCount empty cells
+    void allocateSeedGrid(int cellCount);
+    // return the seed grid cell that includes key, nullptr if the grid is disabled
+    std::atomic<Tile *> *findSeedGridCell(const Cord &key) const;
+    // cells overlapping area that remember oldSeed now remember newSeed (could be nullptr)
+    void reseedGrid(const Rectangle &area, Tile *oldSeed, Tile *newSeed);
+
     // return true if the object is inside the canvas, else return false
     bool checkPointInCanvas(const Cord &point) const;
     bool checkRectangleInCanvas(const Rectangle &rect) const;
@@ -25,20 +79,54 @@ public:
     void collectAllTiles(std::unordered_set<Tile *> &allTiles) const;
     void collectAllTilesDFS(Tile *tile, std::unordered_set<Tile *> &allTiles) const;
 
-    // Helper function of enumerateDirectArea
-    void enumerateDirectedAreaRProcedure(Rectangle box, std::vector <Tile *> &allTiles, Tile *targetTile) const;
+    // rebuild the tiles of other inside this (empty) plane, the old tile -> new tile correspondence is returned through oldNewPairs
+    void copyPlane(const CornerStitching &other, std::unordered_map<Tile *, Tile *> &oldNewPairs);
+
+    // add tile to mNonBlankTiles or mBlankTiles (by its type) / remove it, removal moves the last registered tile into its place
+    void registerTile(Tile *tile);
+    void unregisterTile(Tile *tile);
+    // change the type of a registered tile, moving it to the matching registry
+    void retypeTile(Tile *tile, tileType type);
+
+    // release the memory of a tile that is no longer part of the plane (unregistering it), invalidates remembered tile pointers
+    void freeTile(Tile *tile);
+    // destroy tile and hand its memory back to the heap, or to its arena if it is relocated by relayoutTiles()
+    void releaseTileMemory(Tile *tile);
+
+    // Helper function of visitDirectedArea and visitBlankArea, the visitor receives BLANK tiles if visitBlank, else the nonblank ones.
+    // returns false if the visitor stops the enumeration
+    template <typename Visitor>
+    bool visitDirectedAreaRProcedure(const Rectangle &box, Visitor &visitor, Tile *targetTile, bool visitBlank) const;
+    template <typename Visitor>
+    bool visitAreaTiles(const Rectangle &box, Visitor &visitor, bool visitBlank) const;
+
+    // Walking down the vertical line at x cord x, return the tile next to tile (tile must touch the line and not touch the ground).
+    // The walk follows the stitches below tile, no point-finding is involved
+    Tile *findNextTileDownLine(Tile *tile, len_t x) const;
+    // Walking right along the horizontal line at y cord y, return the tile next to tile (tile must touch the line and not touch the right
+    // side of canvas), following the stitches beside tile
+    Tile *findNextTileRightLine(Tile *tile, len_t y) const;
+
+    // Helper function of checkLocalInvariants, check the stitches of tile, the stitches of its neighbors pointing back to it,
+    // its registration in mNonBlankTiles or mBlankTiles and (if checkStrips) whether a BLANK tile is a maximal horizontal strip
+    bool checkTileInvariants(Tile *tile, bool checkStrips, Tile *&tile1, Tile *&tile2) const;
+    // Builds with CORNERSTITCHING_LOCAL_CHECK defined (make debug) run checkLocalInvariants around area after every insertTile, removeTile
+    // and generalSplitTile and throw on a violation, other builds do nothing
+    void debugCheckLocalInvariants(const Rectangle &area) const;
 
     // Helper functions of findLineTile
-    void findLineTileHorizontalPositive(Tile *initTile, Line line, std::vector<LineTile> &positiveSide);
-    void findLineTileHorizontalNegative(Tile *initTile, Line line, std::vector<LineTile> &negativeSide);
-    void findLineTileVerticalPositive(Tile *initTile, Line line, std::vector<LineTile> &positiveSide);
-    void findLineTileVerticalNegative(Tile *initTile, Line line, std::vector<LineTile> &negativeSide);
+    void findLineTileHorizontalPositive(Tile *initTile, Line line, std::vector<LineTile> &positiveSide) const;
+    void findLineTileHorizontalNegative(Tile *initTile, Line line, std::vector<LineTile> &negativeSide) const;
+    void findLineTileVerticalPositive(Tile *initTile, Line line, std::vector<LineTile> &positiveSide) const;
+    void findLineTileVerticalNegative(Tile *initTile, Line line, std::vector<LineTile> &negativeSide) const;
 
 
 // public:
     CornerStitching();
     CornerStitching(len_t chipWidth, len_t chipHeight);
     CornerStitching(const CornerStitching &other);
+    // Same as the copy constructor, the mapping from every tile of other to its copy is returned through oldNewTiles
+    CornerStitching(const CornerStitching &other, std::unordered_map<Tile *, Tile *> &oldNewTiles);
     ~CornerStitching();
  
     bool operator == (const CornerStitching &comp) const;
@@ -46,8 +134,33 @@ public:
     len_t getCanvasWidth() const;
     len_t getCanvasHeight() const;
 
+    // all nonblank (BLOCK and OVERLAP) tiles of the plane in no particular order, iterating them allocates nothing.
+    // The order changes with every insertion and removal
+    const std::vector<Tile *> &getNonBlankTiles() const;
+    // all BLANK tiles of the plane in no particular order (empty if the plane holds no nonblank tile), iterating them allocates nothing.
+    // The order changes with every modification of the plane
+    const std::vector<Tile *> &getBlankTiles() const;
+
     // Given a Cord, find the tile (could be balnk or block) that includes it.
+    // The walk starts from the last tile found by the calling thread on this plane (if still alive)
     Tile *findPoint(const Cord &key) const;
+    // Same as findPoint(key), but the walk starts from hint, a tile of this plane that is expected to be close to key.
+    // hint == nullptr falls back to findPoint(key)
+    Tile *findPoint(const Cord &key, Tile *hint) const;
+    // Locate many points at once, answers[i] is the tile that includes keys[i].
+    // Queries are answered in Z-order (Morton) order of the keys and each walk starts from the answer of the previous query
+    // (or from the seed grid when that answer misses the key and the grid is enabled)
+    void findPoints(const std::vector<Cord> &keys, std::vector<Tile *> &answers) const;
+    
+    // Divide the canvas into (columns x rows) cells, and let findPoint start from a tile remembered by the cell of the key.
+    // This bounds the point-finding walk regardless of canvas size and tile count, disableSeedGrid() drops the grid
+    void enableSeedGrid(int columns, int rows);
+    void disableSeedGrid();
+
+    // Move all tiles into one contiguous buffer ordered along the Z-order (Morton) curve of their lower-left corners and rewrite the stitches,
+    // so tiles that are close on the plane share cache lines during stitch walks. Meant for phase boundaries: every Tile pointer is invalidated,
+    // oldNewTiles maps each old pointer to its relocated tile. Cannot be called inside a batch
+    void relayoutTiles(std::unordered_map<Tile *, Tile *> &oldNewTiles);
     
     // Given a line segment, search for all tiles attatched to the line
     // If the line is horizontal:
@@ -57,7 +170,7 @@ public:
     //  - positive side returns all tiles that the line tangents(marked RIGHT/EAST) or cross(marked CENTRE) on the right portion of line
     //  - negative side returns all tiles that the line tangents(marked LEFT/WEST) or cross(marked CENTRE) on the left portion of line
     // Note that if a the line crosses the 
-    void findLineTile(Line &line, std::vector<LineTile> &positiveSide, std::vector<LineTile> &negativeSide);
+    void findLineTile(const Line &line, std::vector<LineTile> &positiveSide, std::vector<LineTile> &negativeSide) const;
     
     // Pushes all top neighbors of Tile "centre" to vector "neighbors", the first would be centre->tr, then to left (<--)
     void findTopNeighbors(Tile *centre, std::vector<Tile *> &neighbors) const;
@@ -71,6 +184,12 @@ public:
     // Short hand for continuoutsly call, find Top, Left, Down, Right neighbors
     void findAllNeighbors(Tile *centre, std::vector<Tile *> &neighbors) const;    
 
+    // Allocation-free counterparts of the find*Neighbors functions, the neighbors on side (UP, LEFT, DOWN or RIGHT) of Tile "centre"
+    // are walked on demand, in the same order: for(Tile *neighbor : cs->neighbors(centre, direction2D::UP)){...}
+    TileNeighborRange neighbors(Tile *centre, direction2D side) const;
+    // Neighbors on all sides, in the order of findAllNeighbors
+    TileNeighborRange allNeighbors(Tile *centre) const;
+
     // Determine if there is any nonblank tiles in the box area
     bool searchArea(Rectangle box) const;
     // Determine if there is any nonblank tiles in the box area, return any tile in the region if found (via pointer)
@@ -79,12 +198,46 @@ public:
     // Enumerates all nonblank tiles in a given box area, each tile is visited only after all the tiles above and to its left does
     void enumerateDirectedArea(Rectangle box, std::vector <Tile *> &allTiles) const;
 
+    // Same visiting order as enumerateDirectedArea, but each nonblank tile is handed to visitor (bool visitor(Tile *)) instead of a vector,
+    // and nothing is allocated. The enumeration stops once visitor returns false, the return value is false if it is stopped early
+    template <typename Visitor>
+    bool visitDirectedArea(const Rectangle &box, Visitor &&visitor) const;
+
+    // White space queries. BLANK tiles are maximal horizontal strips kept up to date by every insertion and removal, and all of them are
+    // registered in mBlankTiles, so the blank tiles (reached through the stitches) index the white space, no polygon operation is needed.
+    // visitBlankArea works like visitDirectedArea, but hands the BLANK tiles intersecting box to visitor
+    template <typename Visitor>
+    bool visitBlankArea(const Rectangle &box, Visitor &&visitor) const;
+    // Push the white space inside box to blankRectangles, as disjoint rectangles (the blank tiles clipped by box)
+    void collectBlankArea(const Rectangle &box, std::vector<Rectangle> &blankRectangles) const;
+    // Return the area of white space inside box
+    area_t calculateBlankArea(const Rectangle &box) const;
+    // Push the white space inside box to blankRegions, one entry per connected piece of white space (pieces touching only at a corner
+    // are apart), each as the disjoint rectangles of its clipped blank tiles. The pieces are the polygons boost::polygon would make of
+    // the white space, listed in the same order (by top edge, then by the right end of the top edge), without any polygon operation
+    void collectBlankRegions(const Rectangle &box, std::vector<std::vector<Rectangle>> &blankRegions) const;
+    // Largest blank rectangle extending from a segment: the segment is the side of sweepArea opposite to direction (UP, DOWN, LEFT or RIGHT),
+    // the rectangle grows toward direction within sweepArea, walking the blank tiles in front of it, until it meets the first nonblank tile.
+    // The result has zero area if the segment is blocked at once (a nonblank tile lies right in front of it)
+    Rectangle findBlankExtension(const Rectangle &sweepArea, direction2D direction) const;
+
     // Input a tile "prototype" to insert into the corner stitching system, returns the actual pointer to the tile in the system
     Tile *insertTile(const Tile &tile);
 
     // Removes the tile within system, retunrs false if Tile not within cornerStitching System. true if succes
     void removeTile(Tile *tile);
 
+    // Group several insertTile()/removeTile() calls: between beginBatch() and the matching endBatch() removals only turn the tile BLANK
+    // and insertions skip merging their blank remainders, the blank tiles are canonicalized once when the outermost batch ends.
+    // Inside a batch the plane is a valid tiling but blank tiles may not be maximal strips, only insert/remove and queries are allowed
+    void beginBatch();
+    void endBatch();
+
+    // Build the whole plane at once from non-overlapping, non-blank prototypes (the plane must be empty) in O(n log n):
+    // a single sweep over sorted y-events creates the maximal horizontal blank strips, then stitches are resolved by binary searches.
+    // loadedTiles[i] is the pointer to the tile built from prototypes[i]
+    void bulkLoad(const std::vector<Tile> &prototypes, std::vector<Tile *> &loadedTiles);
+
     // Pass in a victim tile through origTop, it will split the victim into two pieces:
     // 1. origTop represents the top portion of the split, with height (origTop.height - newDownHeight)
     // 2. newDown represents the lower portion of the split, with height newDownHeight, is the return value
@@ -112,9 +265,15 @@ public:
     // two detatched tiles is returned through tile1 and tile2
     bool debugPointerAttatched(Tile *&tile1, Tile *&tile2) const;
 
-    // self checking function, wrapper of debugBlankMerged(...) and debugPointerAttatched(...)
+    // self checking function, wrapper of debugBlankMerged(...) and debugPointerAttatched(...), also checks that the registries hold every tile
     bool conductSelfTest()const;
 
+    // Local counterpart of conductSelfTest(), only checks the tiles (BLANK included) overlapping or touching area, so the cost follows
+    // the size of an edit instead of the plane. Checks stitch consistency on both ends of every stitch around those tiles, that every tile
+    // is registered in mNonBlankTiles or mBlankTiles and, outside of batches, that BLANK tiles are maximal horizontal strips.
+    // returns true if no fails found, else return false and the failing tile(s) through tile1 and tile2 (tile2 could be nullptr)
+    bool checkLocalInvariants(const Rectangle &area, Tile *&tile1, Tile *&tile2) const;
+
     // added by ryan
     // given a tile orignalTile, carves a tile at newArea while spliting the corner stitching
     // of the tile 
@@ -122,4 +281,63 @@ public:
     // and the newly constrcuted neighbors are added to newNeighbors
     Tile* generalSplitTile(Tile* originalTile, Rectangle newArea, std::vector<Tile*>& newNeighbors);
 };
+
+template <typename Visitor>
+bool CornerStitching::visitDirectedAreaRProcedure(const Rectangle &box, Visitor &visitor, Tile *targetTile, bool visitBlank) const{
+
+    // R1) Enumerate the tile
+    if((targetTile->getType() == tileType::BLANK) == visitBlank){
+        if(!visitor(targetTile)) return false;
+    }
+
+    // R2) If the right edge of the tile is outside (or touch) the seearch area, return
+    if(targetTile->getXHigh() >= rec::getXH(box)) return true;
+
+    // R3) Walk (top to bottom) through all the tiles that touch the right side of the current tile and also intersect the search area
+    len_t bottomEdge = rec::getYL(box);
+    bool cutTargetTile = (targetTile->getYLow() <= bottomEdge) && (targetTile->getYHigh() > bottomEdge);
+
+    for(Tile *t = targetTile->tr; t != nullptr; t = t->lb){
+        // make sure the tile is in the AOI
+        if(rec::hasIntersect(t->getRectangle(), box, false)){
+            // R4) If bottom left corner of the neighbor touches the current tile
+            bool R4 = (t->getYLow() >= targetTile->getYLow());
+
+            // R5) If the bottom edge ofthe search area cuts both the target tile and its neighbor
+            bool cutNeighbor = (t->getYLow() <= bottomEdge) && (t->getYHigh() > bottomEdge);
+            bool R5 = cutTargetTile && cutNeighbor;
+
+            if((R4 || R5) && (!visitDirectedAreaRProcedure(box, visitor, t, visitBlank))) return false;
+        }
+        // the last right neighbor is the first one whose lower y cord <= lower y cord of the current tile
+        if(t->getYLow() <= targetTile->getYLow()) break;
+    }
+
+    return true;
+}
+
+template <typename Visitor>
+bool CornerStitching::visitAreaTiles(const Rectangle &box, Visitor &visitor, bool visitBlank) const{
+    // Use point-finding algo to locate the tile containin the upperleft corner of AOI
+    Tile *leftTouchTile = findPoint(Cord(rec::getXL(box), rec::getYH(box) - 1));
+
+    while(leftTouchTile->getYHigh() > rec::getYL(box)){
+        if(!visitDirectedAreaRProcedure(box, visitor, leftTouchTile, visitBlank)) return false;
+        if(leftTouchTile->getYLow() < 1) break;
+        // step to the next tile along the left edge
+        leftTouchTile = findNextTileDownLine(leftTouchTile, rec::getXL(box));
+    }
+
+    return true;
+}
+template <typename Visitor>
+bool CornerStitching::visitDirectedArea(const Rectangle &box, Visitor &&visitor) const{
+    return visitAreaTiles(box, visitor, false);
+}
+
+template <typename Visitor>
+bool CornerStitching::visitBlankArea(const Rectangle &box, Visitor &&visitor) const{
+    return visitAreaTiles(box, visitor, true);
+}
+
 #endif // __CORNERSTITCHING_H__
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include <assert.h>
+#include <cmath>
 #include <algorithm>
 #include <fstream>
 #include <unordered_map>
@@ -14,11 +15,7 @@
 
 // #include "glpk.h"
 
-Rectilinear *Floorplan::placeRectilinear(std::string name, rectilinearType type, Rectangle placement, area_t legalArea, double aspectRatioMin, double aspectRatioMax, double mUtilizationMin){
-    // if(!rec::isContained(mChipContour,placement)){
-    //     throw CSException("FLOORPLAN_16");
-    // }
-
+Rectilinear *Floorplan::createRectilinear(std::string name, rectilinearType type, Rectangle placement, area_t legalArea, double aspectRatioMin, double aspectRatioMax, double mUtilizationMin){
     // register the Rectilinear container into the floorplan data structure
     Rectilinear *newRect = new Rectilinear(mIDCounter++, name, type, placement, legalArea, aspectRatioMin, aspectRatioMax, mUtilizationMin); 
     switch (type){
@@ -32,12 +29,22 @@ Rectilinear *Floorplan::placeRectilinear(std::string name, rectilinearType type,
         break;
     case rectilinearType::PIN:
         this->pinRectilinears.push_back(newRect);
-        return newRect;
         break;
     default:
         break;
     }
 
+    return newRect;
+}
+
+Rectilinear *Floorplan::placeRectilinear(std::string name, rectilinearType type, Rectangle placement, area_t legalArea, double aspectRatioMin, double aspectRatioMax, double mUtilizationMin){
+    // if(!rec::isContained(mChipContour,placement)){
+    //     throw CSException("FLOORPLAN_16");
+    // }
+
+    Rectilinear *newRect = createRectilinear(name, type, placement, legalArea, aspectRatioMin, aspectRatioMax, mUtilizationMin);
+    if(type == rectilinearType::PIN) return newRect;
+
     std::vector<Tile *> lappingTiles;
     cs->enumerateDirectedArea(placement, lappingTiles);
     if(lappingTiles.empty()){
@@ -70,7 +77,7 @@ Rectilinear *Floorplan::placeRectilinear(std::string name, rectilinearType type,
 
                 tileType lapTileType = lapTile->getType();
                 if(lapTileType == tileType::BLOCK){
-                    Rectilinear *origPayload = this->blockTilePayload[lapTile];
+                    Rectilinear *origPayload = lapTile->getBlockPayload();
 
                     deleteTile(lapTile);
 
@@ -88,7 +95,7 @@ Rectilinear *Floorplan::placeRectilinear(std::string name, rectilinearType type,
                         addBlockTile(rt, origPayload);
                     }
                 }else if(lapTileType == tileType::OVERLAP){
-                    std::vector<Rectilinear *> origPaylaod = this->overlapTilePayload[lapTile];
+                    std::vector<Rectilinear *> origPaylaod = lapTile->getOverlapPayload().toVector();
 
                     deleteTile(lapTile);
 
@@ -128,23 +135,492 @@ Rectilinear *Floorplan::placeRectilinear(std::string name, rectilinearType type,
     return newRect;
 }
 
+void Floorplan::bulkPlaceRectilinears(const std::vector<Rectilinear *> &rects, const std::vector<Rectangle> &placements){
+    using namespace boost::polygon::operators;
+    int rectCount = rects.size();
+    if(rectCount == 0) return;
+
+    // sweep the y-events (tops before bottoms at the same y, touching rectangles do not overlap) and keep the rectilinears
+    // crossing the sweep line in a multimap sorted by xLow, a new rectilinear only looks at entries starting in [xl - maxWidth, xh)
+    std::vector<std::pair<len_t, int>> yEvents;
+    len_t maxWidth = 0;
+    for(int r = 0; r < rectCount; ++r){
+        yEvents.push_back({rec::getYL(placements[r]), r + 1});
+        yEvents.push_back({rec::getYH(placements[r]), -(r + 1)});
+        maxWidth = std::max(maxWidth, rec::getWidth(placements[r]));
+    }
+    std::sort(yEvents.begin(), yEvents.end());
+
+    // rectilinears connected through overlaps form a cluster, clusters are placed independently of each other
+    std::vector<int> clusterRoot(rectCount);
+    for(int r = 0; r < rectCount; ++r) clusterRoot[r] = r;
+    auto findRoot = [&](int r){
+        while(clusterRoot[r] != r){
+            clusterRoot[r] = clusterRoot[clusterRoot[r]];
+            r = clusterRoot[r];
+        }
+        return r;
+    };
+
+    std::multimap<len_t, int> activeRects;
+    std::vector<std::multimap<len_t, int>::iterator> activeHandles(rectCount);
+    for(std::pair<len_t, int> const &event : yEvents){
+        if(event.second < 0){
+            activeRects.erase(activeHandles[-event.second - 1]);
+            continue;
+        }
+        int r = event.second - 1;
+        len_t xl = rec::getXL(placements[r]);
+        len_t xh = rec::getXH(placements[r]);
+        for(std::multimap<len_t, int>::iterator it = activeRects.lower_bound(xl - maxWidth); (it != activeRects.end()) && (it->first < xh); ++it){
+            if(rec::getXH(placements[it->second]) <= xl) continue;
+            int rootA = findRoot(r);
+            int rootB = findRoot(it->second);
+            if(rootA != rootB) clusterRoot[std::max(rootA, rootB)] = std::min(rootA, rootB);
+        }
+        activeHandles[r] = activeRects.insert({xl, r});
+    }
+
+    std::vector<std::vector<int>> clusters(rectCount);
+    for(int r = 0; r < rectCount; ++r){
+        clusters[findRoot(r)].push_back(r);
+    }
+
+    // replay the one-by-one insertion of placeRectilinear inside each cluster on plain rectangles, so the resulting pieces
+    // (and the payload order of overlap tiles) are exactly the tiles sequential placement would produce
+    std::vector<DoughnutPolygonSet> blockParts(rectCount);
+    std::vector<std::pair<Rectangle, std::vector<int>>> overlapPieces;
+    for(std::vector<int> const &cluster : clusters){
+        if(cluster.size() == 1){
+            blockParts[cluster[0]] += placements[cluster[0]];
+            continue;
+        }
+
+        std::vector<std::pair<Rectangle, std::vector<int>>> pieces;
+        std::vector<bool> pieceAlive;
+        for(int const &r : cluster){
+            Rectangle const &placement = placements[r];
+            DoughnutPolygonSet insertSet;
+            insertSet += placement;
+
+            int pieceCount = pieces.size();
+            for(int p = 0; p < pieceCount; ++p){
+                if((!pieceAlive[p]) || (!rec::hasIntersect(pieces[p].first, placement, false))) continue;
+
+                DoughnutPolygonSet origTileSet;
+                origTileSet += pieces[p].first;
+                DoughnutPolygonSet overlapSet;
+                boost::polygon::assign(overlapSet, insertSet & origTileSet);
+
+                if(boost::polygon::equivalence(origTileSet, overlapSet)){
+                    pieces[p].second.push_back(r);
+                }else{
+                    pieceAlive[p] = false;
+                    std::vector<int> origPayload = pieces[p].second;
+
+                    std::vector<Rectangle> intersectRect;
+                    dps::diceIntoRectangles(overlapSet, intersectRect);
+                    assert(intersectRect.size() == 1);
+                    std::vector<int> newPayload(origPayload);
+                    newPayload.push_back(r);
+                    pieces.push_back({intersectRect[0], newPayload});
+                    pieceAlive.push_back(true);
+
+                    origTileSet -= overlapSet;
+                    std::vector<Rectangle> restRect;
+                    dps::diceIntoRectangles(origTileSet, restRect);
+                    for(Rectangle const &rt : restRect){
+                        pieces.push_back({rt, origPayload});
+                        pieceAlive.push_back(true);
+                    }
+                }
+                insertSet -= overlapSet;
+            }
+
+            std::vector<Rectangle> remainInsertRect;
+            dps::diceIntoRectangles(insertSet, remainInsertRect);
+            for(Rectangle const &rt : remainInsertRect){
+                pieces.push_back({rt, std::vector<int>({r})});
+                pieceAlive.push_back(true);
+            }
+        }
+
+        for(size_t p = 0; p < pieces.size(); ++p){
+            if(!pieceAlive[p]) continue;
+            if(pieces[p].second.size() == 1) blockParts[pieces[p].second[0]] += pieces[p].first;
+            else overlapPieces.push_back(pieces[p]);
+        }
+    }
+
+    // collect tile prototypes and their payloads, then build the cornerStitching plane in one go
+    std::vector<Tile> prototypes;
+    std::vector<int> blockPayloads;
+    for(int r = 0; r < rectCount; ++r){
+        std::vector<Rectangle> blockRects;
+        dps::diceIntoRectangles(blockParts[r], blockRects);
+        for(Rectangle const &blockRect : blockRects){
+            prototypes.push_back(Tile(tileType::BLOCK, blockRect));
+            blockPayloads.push_back(r);
+        }
+    }
+    for(std::pair<Rectangle, std::vector<int>> const &piece : overlapPieces){
+        prototypes.push_back(Tile(tileType::OVERLAP, piece.first));
+    }
+
+    std::vector<Tile *> loadedTiles;
+    cs->bulkLoad(prototypes, loadedTiles);
+
+    int blockTileCount = blockPayloads.size();
+    for(int t = 0; t < blockTileCount; ++t){
+        Rectilinear *rt = rects[blockPayloads[t]];
+        rt->blockTiles.insert(loadedTiles[t]);
+        addCoveredRegion(rt, loadedTiles[t]->getRectangle());
+        loadedTiles[t]->mBlockPayload = rt;
+        notifyObservers(floorplanEventType::TILE_CREATED, loadedTiles[t], loadedTiles[t]->getRectangle(), {}, true);
+    }
+    for(size_t p = 0; p < overlapPieces.size(); ++p){
+        Tile *overlapTile = loadedTiles[blockTileCount + p];
+        std::vector<Rectilinear *> payload;
+        for(int const &r : overlapPieces[p].second){
+            payload.push_back(rects[r]);
+            rects[r]->overlapTiles.insert(overlapTile);
+            addCoveredRegion(rects[r], overlapTile->getRectangle());
+        }
+        overlapTile->mOverlapPayload = payload;
+        notifyObservers(floorplanEventType::TILE_CREATED, overlapTile, overlapTile->getRectangle(), {}, true);
+    }
+    this->mOverlapTileCount += overlapPieces.size();
+}
+
+void Floorplan::markCompactionDirty(Tile *tile){
+    if(tile->getType() == tileType::BLOCK){
+        this->mCompactionDirty.insert(tile->getBlockPayload());
+    }else if(tile->getType() == tileType::OVERLAP){
+        for(Rectilinear *const &rt : tile->getOverlapPayload()){
+            this->mCompactionDirty.insert(rt);
+        }
+    }
+}
+
+void Floorplan::addCoveredRegion(Rectilinear *rt, const Rectangle &tileRectangle){
+    rt->growShape(tileRectangle);
+}
+
+void Floorplan::removeCoveredRegion(Rectilinear *rt, const Rectangle &tileRectangle){
+    rt->shrinkShape(tileRectangle);
+}
+
+void Floorplan::addTileCoverage(Tile *tile){
+    if(tile->getType() == tileType::BLOCK){
+        addCoveredRegion(tile->getBlockPayload(), tile->getRectangle());
+    }else if(tile->getType() == tileType::OVERLAP){
+        for(Rectilinear *const &rt : tile->getOverlapPayload()){
+            addCoveredRegion(rt, tile->getRectangle());
+        }
+    }
+}
+
+void Floorplan::removeTileCoverage(Tile *tile){
+    if(tile->getType() == tileType::BLOCK){
+        removeCoveredRegion(tile->getBlockPayload(), tile->getRectangle());
+    }else if(tile->getType() == tileType::OVERLAP){
+        for(Rectilinear *const &rt : tile->getOverlapPayload()){
+            removeCoveredRegion(rt, tile->getRectangle());
+        }
+    }
+}
+
+void Floorplan::refreshLegality(int position) const{
+    rectilinearIllegalType verdict;
+    int preplacedCount = this->preplacedRectilinears.size();
+    if(position < preplacedCount){
+        // a preplaced rectilinear must still cover exactly its global placement
+        using namespace boost::polygon::operators;
+        Rectilinear *rt = this->preplacedRectilinears[position];
+        DoughnutPolygonSet currentShape;
+        for(Tile *const &fragment : rt->blockTiles){
+            currentShape += fragment->getRectangle();
+        }
+        std::vector<Rectangle> diceResult;
+        dps::diceIntoRectangles(currentShape, diceResult);
+        bool samePlacement = (diceResult.size() == 1) && (diceResult[0] == rt->getGlboalPlacement());
+        verdict = (samePlacement)? rectilinearIllegalType::LEGAL : rectilinearIllegalType::PREPLACE_FAIL;
+    }else{
+        this->softRectilinears[position - preplacedCount]->isLegal(verdict);
+    }
+
+    this->mLegalityVerdicts[position] = verdict;
+    if(verdict == rectilinearIllegalType::LEGAL){
+        this->mIllegalPositions.erase(position);
+    }else{
+        this->mIllegalPositions.insert(position);
+    }
+}
+
+void Floorplan::copyLegalityCache(const Floorplan &other, const std::unordered_map<Rectilinear *, Rectilinear *> &rectMap){
+    // the rectilinear lists are copied in order, so the verdicts carry over as they are
+    this->mLegalityVerdicts = other.mLegalityVerdicts;
+    this->mIllegalPositions = other.mIllegalPositions;
+
+    this->mLegalityDirty.clear();
+    for(Rectilinear *const &oldR : other.mLegalityDirty){
+        this->mLegalityDirty.insert(rectMap.at(oldR));
+    }
+
+    this->mLegalityOrder.clear();
+    for(std::unordered_map<Rectilinear *, int>::const_iterator it = other.mLegalityOrder.begin(); it != other.mLegalityOrder.end(); ++it){
+        this->mLegalityOrder[rectMap.at(it->first)] = it->second;
+    }
+}
+
+double Floorplan::evaluateConnectionCost(int connectionIdx) const{
+    const std::vector<Rectilinear *> &vertices = this->allConnections[connectionIdx]->vertices;
+    if(vertices.size() < 2){
+        throw CSException("CONNECTION_01");
+    }
+
+    const FCord &firstCentre = this->mHPWLCentres.at(vertices[0]);
+    double minX, maxX, minY, maxY;
+    minX = maxX = firstCentre.x();
+    minY = maxY = firstCentre.y();
+
+    for(size_t i = 1; i < vertices.size(); ++i){
+        const FCord &centre = this->mHPWLCentres.at(vertices[i]);
+        if(centre.x() < minX) minX = centre.x();
+        if(centre.x() > maxX) maxX = centre.x();
+        if(centre.y() < minY) minY = centre.y();
+        if(centre.y() > maxY) maxY = centre.y();
+    }
+
+    return this->allConnections[connectionIdx]->weight * ((maxX - minX)+(maxY - minY));
+}
+
+void Floorplan::copyHPWLCache(const Floorplan &other, const std::unordered_map<Rectilinear *, Rectilinear *> &rectMap){
+    // connections are copied in order, so the per-connection costs carry over as they are
+    this->mHPWLConnectionCosts = other.mHPWLConnectionCosts;
+
+    this->mHPWLDirty.clear();
+    for(Rectilinear *const &oldR : other.mHPWLDirty){
+        this->mHPWLDirty.insert(rectMap.at(oldR));
+    }
+
+    this->mHPWLCentres.clear();
+    for(std::unordered_map<Rectilinear *, FCord>::const_iterator it = other.mHPWLCentres.begin(); it != other.mHPWLCentres.end(); ++it){
+        this->mHPWLCentres[rectMap.at(it->first)] = it->second;
+    }
+
+    this->mHPWLRectilinearConnections.clear();
+    for(std::unordered_map<Rectilinear *, std::vector<int>>::const_iterator it = other.mHPWLRectilinearConnections.begin(); it != other.mHPWLRectilinearConnections.end(); ++it){
+        this->mHPWLRectilinearConnections[rectMap.at(it->first)] = it->second;
+    }
+}
+
+void Floorplan::compactTileGroup(const std::vector<Tile *> &tiles, const std::vector<Rectilinear *> &payload){
+    if(tiles.size() <= 1) return;
+    using namespace boost::polygon::operators;
+    DoughnutPolygonSet groupPart;
+    std::unordered_map<Rectangle, Tile*> rectanglesToDelete;
+
+    for(Tile *const &tile : tiles){
+        Rectangle tileRectangle = tile->getRectangle();
+        rectanglesToDelete[tileRectangle] = tile;
+        groupPart += tileRectangle;
+    }
+
+    std::vector<Rectangle> diceResult;
+    dps::diceIntoRectangles(groupPart, diceResult);
+    if(diceResult.size() >= tiles.size()) return;
+
+    std::vector<Rectangle> rectanglesToAdd;
+    for(Rectangle const &diceRect : diceResult){
+        if(rectanglesToDelete.find(diceRect) != rectanglesToDelete.end()){
+            rectanglesToDelete.erase(diceRect);
+        }else{
+            rectanglesToAdd.push_back(diceRect);
+        }
+    }
+
+    for(std::unordered_map<Rectangle, Tile*>::iterator it = rectanglesToDelete.begin(); it != rectanglesToDelete.end(); ++it){
+        deleteTile(it->second);
+    }
+
+    for(Rectangle const &toAddRect : rectanglesToAdd){
+        if(payload.size() == 1){
+            addBlockTile(toAddRect, payload[0]);
+        }else{
+            addOverlapTile(toAddRect, payload);
+        }
+    }
+}
+
+bool Floorplan::isJournalling() const{
+    return ((mLiveSnapshotCount > 0) || (!mTransactionMarks.empty())) && (!mJournalReplaying);
+}
+
+void Floorplan::logTileAdded(Tile *tile){
+    markCompactionDirty(tile);
+    if(tile->getType() == tileType::OVERLAP) ++this->mOverlapTileCount;
+    if(!isJournalling()) return;
+    mJournal.push_back({journalEntryType::TILE_ADDED, tile->getRectangle(), tile->getType(), {}});
+}
+
+void Floorplan::logTileRemoved(Tile *tile){
+    markCompactionDirty(tile);
+    if(tile->getType() == tileType::OVERLAP) --this->mOverlapTileCount;
+    if(!isJournalling()) return;
+    if(tile->getType() == tileType::BLOCK){
+        mJournal.push_back({journalEntryType::TILE_REMOVED, tile->getRectangle(), tileType::BLOCK, {tile->getBlockPayload()}});
+    }else{
+        mJournal.push_back({journalEntryType::TILE_REMOVED, tile->getRectangle(), tileType::OVERLAP, tile->getOverlapPayload().toVector()});
+    }
+}
+
+void Floorplan::logTilePayloadChanged(Tile *tile){
+    markCompactionDirty(tile);
+    if(!isJournalling()) return;
+    if(tile->getType() == tileType::BLOCK){
+        mJournal.push_back({journalEntryType::TILE_PAYLOAD_CHANGED, tile->getRectangle(), tileType::BLOCK, {tile->getBlockPayload()}});
+    }else{
+        mJournal.push_back({journalEntryType::TILE_PAYLOAD_CHANGED, tile->getRectangle(), tileType::OVERLAP, tile->getOverlapPayload().toVector()});
+    }
+}
+
+void Floorplan::retypeTile(Tile *tile, tileType type){
+    if(tile->getType() == tileType::OVERLAP) --this->mOverlapTileCount;
+    tile->setType(type);
+    if(type == tileType::OVERLAP) ++this->mOverlapTileCount;
+}
+
+void Floorplan::collectTilePayload(Tile *tile, std::vector<Rectilinear *> &payload) const{
+    if(tile->getType() == tileType::BLOCK){
+        if(tile->mBlockPayload != nullptr) payload.push_back(tile->mBlockPayload);
+    }else if(tile->getType() == tileType::OVERLAP){
+        payload.insert(payload.end(), tile->mOverlapPayload.begin(), tile->mOverlapPayload.end());
+    }
+}
+
+void Floorplan::notifyObservers(floorplanEventType type, Tile *tile, const Rectangle &oldTileRectangle, const std::vector<Rectilinear *> &oldPayload, bool reshaping){
+    FloorplanEvent event = {type, tile, tile->getRectangle(), oldTileRectangle, {}, {}, nullptr};
+    collectTilePayload(tile, event.rectilinears);
+    int currentPayloadSize = event.rectilinears.size();
+    for(Rectilinear *const &oldRect : oldPayload){
+        if(std::find(event.rectilinears.begin(), event.rectilinears.end(), oldRect) == event.rectilinears.end()){
+            event.rectilinears.push_back(oldRect);
+        }
+    }
+
+    if(reshaping && !mCompactingTiles){
+        if(type == floorplanEventType::PAYLOAD_CHANGED){
+            // the tile's region moves between rectilinears: only those gaining or losing it are reshaped
+            for(int i = 0; i < currentPayloadSize; ++i){
+                Rectilinear *rt = event.rectilinears[i];
+                if(std::find(oldPayload.begin(), oldPayload.end(), rt) == oldPayload.end()){
+                    event.reshapedRectilinears.push_back(rt);
+                }
+            }
+            event.reshapedRectilinears.insert(event.reshapedRectilinears.end(), event.rectilinears.begin() + currentPayloadSize, event.rectilinears.end());
+        }else{
+            event.reshapedRectilinears = event.rectilinears;
+        }
+    }
+
+    dispatchEvent(event);
+}
+
+void Floorplan::dispatchEvent(const FloorplanEvent &event){
+    for(FloorplanObserver *const &observer : mObservers){
+        observer->onFloorplanEvent(event);
+    }
+}
+
+void Floorplan::undoJournalTo(size_t position){
+    // undo in reverse order, the undo itself must not be journalled
+    mJournalReplaying = true;
+    while(mJournal.size() > position){
+        FloorplanJournalEntry entry = mJournal.back();
+        mJournal.pop_back();
+        undoJournalEntry(entry);
+    }
+    mJournalReplaying = false;
+}
+
+void Floorplan::trimJournal(){
+    if((mLiveSnapshotCount == 0) && (mTransactionMarks.empty())){
+        mJournal.clear();
+    }
+}
+
+void Floorplan::undoJournalEntry(const FloorplanJournalEntry &entry){
+    // re-insert the removed tile with its exact payload
+    if(entry.type == journalEntryType::TILE_REMOVED){
+        if(entry.oldTileType == tileType::BLOCK){
+            addBlockTile(entry.tileRectangle, entry.oldPayload[0]);
+        }else{
+            addOverlapTile(entry.tileRectangle, entry.oldPayload);
+        }
+        return;
+    }
+
+    // the rest of the entries work on a tile that currently exists with exactly the journalled geometry
+    Tile *tile = cs->findPoint(rec::getLL(entry.tileRectangle));
+    if((tile->getType() == tileType::BLANK) || (tile->getRectangle() != entry.tileRectangle)){
+        throw CSException("FLOORPLAN_29");
+    }
+
+    if(entry.type == journalEntryType::TILE_ADDED){
+        deleteTile(tile);
+        return;
+    }
+
+    // TILE_PAYLOAD_CHANGED: detach tile from its current payload, then attach it back to the old payload
+    std::vector<Rectilinear *> replacedPayload;
+    collectTilePayload(tile, replacedPayload);
+    removeTileCoverage(tile);
+    if(tile->getType() == tileType::BLOCK){
+        tile->mBlockPayload->blockTiles.erase(tile);
+        tile->mBlockPayload = nullptr;
+    }else{
+        for(Rectilinear *const &rt : tile->mOverlapPayload){
+            rt->overlapTiles.erase(tile);
+        }
+        tile->mOverlapPayload.clear();
+    }
+
+    retypeTile(tile, entry.oldTileType);
+    if(entry.oldTileType == tileType::BLOCK){
+        entry.oldPayload[0]->blockTiles.insert(tile);
+        tile->mBlockPayload = entry.oldPayload[0];
+    }else{
+        for(Rectilinear *const &rt : entry.oldPayload){
+            rt->overlapTiles.insert(tile);
+        }
+        tile->mOverlapPayload = entry.oldPayload;
+    }
+    addTileCoverage(tile);
+    notifyObservers(floorplanEventType::PAYLOAD_CHANGED, tile, tile->getRectangle(), replacedPayload, true);
+}
+
 // modified by ryan: 
 // added initializers for all member functions
 Floorplan::Floorplan()
     : mIDCounter(0), mChipContour(Rectangle(0, 0, 0, 0)) , mAllRectilinearCount(0), mSoftRectilinearCount(0), mPreplacedRectilinearCount(0), mConnectionCount(0),
-    mGlobalAspectRatioMin(0.0), mGlobalAspectRatioMax(0.0), mGlobalUtilizationMin(0.0), cs(NULL) {
+    mGlobalAspectRatioMin(0.0), mGlobalAspectRatioMax(0.0), mGlobalUtilizationMin(0.0), mLiveSnapshotCount(0), mJournalReplaying(false), mCompactingTiles(false), mOverlapTileCount(0), cs(NULL) {
 }
 
 // modified by ryan: 
 // added mIDCounter(0)
 Floorplan::Floorplan(const GlobalResult &gr, double aspectRatioMin, double aspectRatioMax, double utilizationMin)
-    : mIDCounter(0), mGlobalAspectRatioMin(aspectRatioMin), mGlobalAspectRatioMax(aspectRatioMax), mGlobalUtilizationMin(utilizationMin) {
+    : mIDCounter(0), mGlobalAspectRatioMin(aspectRatioMin), mGlobalAspectRatioMax(aspectRatioMax), mGlobalUtilizationMin(utilizationMin),
+    mLiveSnapshotCount(0), mJournalReplaying(false), mCompactingTiles(false), mOverlapTileCount(0) {
 
     mChipContour = Rectangle(0, 0, gr.chipWidth, gr.chipHeight);
     mAllRectilinearCount = gr.blockCount;
     mConnectionCount = gr.connectionCount;
 
     cs = new CornerStitching(gr.chipWidth, gr.chipHeight);
+    // roughly one seed grid cell per block keeps point-finding walks short on large canvases
+    int seedGridSide = std::max(1, int(std::ceil(std::sqrt(double(mAllRectilinearCount)))));
+    cs->enableSeedGrid(seedGridSide, seedGridSide);
     
     assert(mAllRectilinearCount == gr.blocks.size());
     assert(mConnectionCount == gr.connections.size());
@@ -158,6 +634,10 @@ Floorplan::Floorplan(const GlobalResult &gr, double aspectRatioMin, double aspec
     mPreplacedRectilinearCount = 0;
     mPinRectilinearCount = 0;
 
+    // rectilinears that occupy area are placed all at once after every one is registered
+    std::vector<Rectilinear *> placedRectilinears;
+    std::vector<Rectangle> placements;
+
     for(int i = 0; i < mAllRectilinearCount; ++i){
         GlobalResultBlock grb = gr.blocks[i];
         rectilinearType rType;
@@ -176,15 +656,18 @@ Floorplan::Floorplan(const GlobalResult &gr, double aspectRatioMin, double aspec
             throw CSException("FLOORPLAN_01");
         }
 
-        Rectilinear *newRect = placeRectilinear(grb.name, rType, Rectangle(grb.llx, grb.lly, (grb.llx + grb.width), (grb.lly + grb.height)),
+        Rectangle placement(grb.llx, grb.lly, (grb.llx + grb.width), (grb.lly + grb.height));
+        Rectilinear *newRect = createRectilinear(grb.name, rType, placement,
                         grb.legalArea, this->mGlobalAspectRatioMin, this->mGlobalAspectRatioMax, this->mGlobalUtilizationMin);
+        if(rType != rectilinearType::PIN){
+            placedRectilinears.push_back(newRect);
+            placements.push_back(placement);
+        }
 
         nameToRectilinear[grb.name] = newRect;
     }
-    // Reshape all Rectilinears after insertion complete, order of insertion causes excessive splitting
-    for(Rectilinear* const &rect : this->allRectilinears){
-        reshapeRectilinear(rect);
-    }
+    // block tiles come out already diced per Rectilinear, as reshapeRectilinear would do after one-by-one insertion
+    bulkPlaceRectilinears(placedRectilinears, placements);
     
     // create Connections
     // 2024/04/10 Hank's update: add connectonMap
@@ -208,13 +691,17 @@ Floorplan::Floorplan(const GlobalResult &gr, double aspectRatioMin, double aspec
 }
 
 Floorplan::Floorplan(const LegalResult &lr, double aspectRatioMin, double aspectRatioMax, double utilizationMin)
-    : mGlobalAspectRatioMin(aspectRatioMin), mGlobalAspectRatioMax(aspectRatioMax), mGlobalUtilizationMin(utilizationMin) {
+    : mGlobalAspectRatioMin(aspectRatioMin), mGlobalAspectRatioMax(aspectRatioMax), mGlobalUtilizationMin(utilizationMin),
+    mLiveSnapshotCount(0), mJournalReplaying(false), mCompactingTiles(false), mOverlapTileCount(0) {
 
     mChipContour = Rectangle(0, 0, lr.chipWidth, lr.chipHeight);
     mAllRectilinearCount = lr.softBlockCount + lr.fixedBlockCount;
     mConnectionCount = lr.connectionCount;
 
     cs = new CornerStitching(lr.chipWidth, lr.chipHeight);
+    // roughly one seed grid cell per block keeps point-finding walks short on large canvases
+    int seedGridSide = std::max(1, int(std::ceil(std::sqrt(double(mAllRectilinearCount)))));
+    cs->enableSeedGrid(seedGridSide, seedGridSide);
 
     // map for connection linking
     std::unordered_map<std::string, Rectilinear*> nameToRectilinear;
@@ -293,7 +780,8 @@ Floorplan::Floorplan(const LegalResult &lr, double aspectRatioMin, double aspect
 
 }
 
-Floorplan::Floorplan(const Floorplan &other){
+Floorplan::Floorplan(const Floorplan &other)
+    : mLiveSnapshotCount(0), mJournalReplaying(false), mCompactingTiles(false), mOverlapTileCount(other.mOverlapTileCount) {
     
     // copy basic attributes
     this->mIDCounter = other.mIDCounter;
@@ -309,29 +797,29 @@ Floorplan::Floorplan(const Floorplan &other){
     this->mGlobalAspectRatioMax = other.mGlobalAspectRatioMax;
     this->mGlobalUtilizationMin = other.mGlobalUtilizationMin;
 
-    this->cs = new CornerStitching(*other.cs);
+    // the CornerStitching copy pairs every old tile with its new copy through tileMap
+    std::unordered_map<Tile *, Tile *> tileMap;
+    this->cs = new CornerStitching(*other.cs, tileMap);
 
     // build maps to assist copy
     std::unordered_map<Rectilinear *, Rectilinear*> rectMap;
-    std::unordered_map<Tile *, Tile *> tileMap;
+    rectMap.reserve(other.allRectilinears.size() + other.pinRectilinears.size());
 
     for(Rectilinear *const &oldRect : other.allRectilinears){
         Rectilinear *nR = new Rectilinear(*oldRect);
 
         // re-consruct the block tiles pointers using the new CornerStitching System
         nR->blockTiles.clear();
+        nR->blockTiles.reserve(oldRect->blockTiles.size());
         for(Tile *const &oldT : oldRect->blockTiles){
-            Tile *newT = this->cs->findPoint(oldT->getLowerLeft());
-            tileMap[oldT] = newT;
-            nR->blockTiles.insert(newT);
+            nR->blockTiles.insert(tileMap[oldT]);
         }
 
         // re-consruct the overlap tiles pointers using the new CornerStitching System
         nR->overlapTiles.clear();
+        nR->overlapTiles.reserve(oldRect->overlapTiles.size());
         for(Tile *const &oldT : oldRect->overlapTiles){
-            Tile *newT = this->cs->findPoint(oldT->getLowerLeft());
-            tileMap[oldT] = newT;
-            nR->overlapTiles.insert(newT);
+            nR->overlapTiles.insert(tileMap[oldT]);
         }
 
         rectMap[oldRect] = nR;
@@ -403,24 +891,24 @@ Floorplan::Floorplan(const Floorplan &other){
     }
 
     // rebuid Tile payloads section  
-    this->blockTilePayload.clear();
-    for(std::unordered_map<Tile *, Rectilinear *>::const_iterator it = other.blockTilePayload.begin(); it != other.blockTilePayload.end(); ++it){
-        Tile *nT = tileMap[it->first];
-        Rectilinear *nR = rectMap[it->second];
-
-        this->blockTilePayload[nT] = nR;
+    // the copied tiles still carry other's rectilinears as payload, redirect them
+    for(Tile *const &nT : this->cs->getNonBlankTiles()){
+        if(nT->getType() == tileType::BLOCK){
+            nT->mBlockPayload = rectMap[nT->mBlockPayload];
+        }else{
+            for(Rectilinear *&nR : nT->mOverlapPayload){
+                nR = rectMap[nR];
+            }
+        }
     }
 
-    this->overlapTilePayload.clear();
-    for(std::unordered_map<Tile *, std::vector<Rectilinear *>>::const_iterator it = other.overlapTilePayload.begin(); it != other.overlapTilePayload.end(); ++it){
-        Tile *nT = tileMap[it->first];
-        std::vector<Rectilinear *> nRectVec;
-        for(Rectilinear *const &oldR : it->second){
-            nRectVec.push_back(rectMap[oldR]);
-        }
-        
-        this->overlapTilePayload[nT] = nRectVec;
+    this->mCompactionDirty.clear();
+    for(Rectilinear *const &oldR : other.mCompactionDirty){
+        this->mCompactionDirty.insert(rectMap[oldR]);
     }
+
+    copyHPWLCache(other, rectMap);
+    copyLegalityCache(other, rectMap);
     
 }
 
@@ -441,6 +929,13 @@ Floorplan::~Floorplan(){
 }
 
 Floorplan &Floorplan::operator = (const Floorplan &other){
+    // snapshots and transactions of the old content are meaningless to the new content
+    this->mLiveSnapshotCount = 0;
+    this->mTransactionMarks.clear();
+    this->mJournalReplaying = false;
+    this->mJournal.clear();
+    this->mCompactingTiles = false;
+
     // copy basic attributes
     this->mChipContour = Rectangle(other.mChipContour);
     this->mAllRectilinearCount = other.mAllRectilinearCount;
@@ -454,29 +949,29 @@ Floorplan &Floorplan::operator = (const Floorplan &other){
     this->mGlobalAspectRatioMax = other.mGlobalAspectRatioMax;
     this->mGlobalUtilizationMin = other.mGlobalUtilizationMin;
 
-    this->cs = new CornerStitching(*other.cs);
+    // the CornerStitching copy pairs every old tile with its new copy through tileMap
+    std::unordered_map<Tile *, Tile *> tileMap;
+    this->cs = new CornerStitching(*other.cs, tileMap);
 
     // build maps to assist copy
     std::unordered_map<Rectilinear *, Rectilinear*> rectMap;
-    std::unordered_map<Tile *, Tile *> tileMap;
+    rectMap.reserve(other.allRectilinears.size() + other.pinRectilinears.size());
 
     for(Rectilinear *const &oldRect : other.allRectilinears){
         Rectilinear *nR = new Rectilinear(*oldRect);
 
         // re-consruct the block tiles pointers using the new CornerStitching System
         nR->blockTiles.clear();
+        nR->blockTiles.reserve(oldRect->blockTiles.size());
         for(Tile *const &oldT : oldRect->blockTiles){
-            Tile *newT = this->cs->findPoint(oldT->getLowerLeft());
-            tileMap[oldT] = newT;
-            nR->blockTiles.insert(newT);
+            nR->blockTiles.insert(tileMap[oldT]);
         }
 
         // re-consruct the overlap tiles pointers using the new CornerStitching System
         nR->overlapTiles.clear();
+        nR->overlapTiles.reserve(oldRect->overlapTiles.size());
         for(Tile *const &oldT : oldRect->overlapTiles){
-            Tile *newT = this->cs->findPoint(oldT->getLowerLeft());
-            tileMap[oldT] = newT;
-            nR->overlapTiles.insert(newT);
+            nR->overlapTiles.insert(tileMap[oldT]);
         }
 
         rectMap[oldRect] = nR;
@@ -537,25 +1032,26 @@ Floorplan &Floorplan::operator = (const Floorplan &other){
     }
 
     // rebuid Tile payloads section  
-    this->blockTilePayload.clear();
-    for(std::unordered_map<Tile *, Rectilinear *>::const_iterator it = other.blockTilePayload.begin(); it != other.blockTilePayload.end(); ++it){
-        Tile *nT = tileMap[it->first];
-        Rectilinear *nR = rectMap[it->second];
-
-        this->blockTilePayload[nT] = nR;
+    // the copied tiles still carry other's rectilinears as payload, redirect them
+    for(Tile *const &nT : this->cs->getNonBlankTiles()){
+        if(nT->getType() == tileType::BLOCK){
+            nT->mBlockPayload = rectMap[nT->mBlockPayload];
+        }else{
+            for(Rectilinear *&nR : nT->mOverlapPayload){
+                nR = rectMap[nR];
+            }
+        }
     }
 
-    this->overlapTilePayload.clear();
-    for(std::unordered_map<Tile *, std::vector<Rectilinear *>>::const_iterator it = other.overlapTilePayload.begin(); it != other.overlapTilePayload.end(); ++it){
-        Tile *nT = tileMap[it->first];
-        std::vector<Rectilinear *> nRectVec;
-        for(Rectilinear *const &oldR : it->second){
-            nRectVec.push_back(rectMap[oldR]);
-        }
-        
-        this->overlapTilePayload[nT] = nRectVec;
+    this->mCompactionDirty.clear();
+    for(Rectilinear *const &oldR : other.mCompactionDirty){
+        this->mCompactionDirty.insert(rectMap[oldR]);
     }
 
+    copyHPWLCache(other, rectMap);
+    this->mOverlapTileCount = other.mOverlapTileCount;
+    copyLegalityCache(other, rectMap);
+
     return (*this);
 }
 
@@ -605,6 +1101,14 @@ void Floorplan::setGlobalUtilizationMin(double globalUtilizationMin){
     this->mGlobalUtilizationMin = globalUtilizationMin;
 }
 
+void Floorplan::addObserver(FloorplanObserver *observer){
+    this->mObservers.push_back(observer);
+}
+
+void Floorplan::removeObserver(FloorplanObserver *observer){
+    this->mObservers.erase(std::remove(this->mObservers.begin(), this->mObservers.end(), observer), this->mObservers.end());
+}
+
 Tile *Floorplan::addBlockTile(const Rectangle &tilePosition, Rectilinear *rt){
     // if(rt->getType() == rectilinearType::PIN){
     //     throw CSException("FLOORPLAN_24");
@@ -624,7 +1128,10 @@ Tile *Floorplan::addBlockTile(const Rectangle &tilePosition, Rectilinear *rt){
     // register the pointer to the rectilienar system 
     rt->blockTiles.insert(newTile);
     // connect tile's payload as the rectilinear on the floorplan system 
-    this->blockTilePayload[newTile] = rt;
+    newTile->mBlockPayload = rt;
+    logTileAdded(newTile);
+    addTileCoverage(newTile);
+    notifyObservers(floorplanEventType::TILE_CREATED, newTile, tilePosition, {}, true);
 
     return newTile;
 }
@@ -652,40 +1159,37 @@ Tile *Floorplan::addOverlapTile(const Rectangle &tilePosition, const std::vector
     }
 
     // connect tile's payload 
-    this->overlapTilePayload[newTile] = std::vector<Rectilinear *>(payload);
+    newTile->mOverlapPayload = payload;
+    logTileAdded(newTile);
+    addTileCoverage(newTile);
+    notifyObservers(floorplanEventType::TILE_CREATED, newTile, tilePosition, {}, true);
 
     return newTile;
 }
 
 void Floorplan::deleteTile(Tile *tile){
+    logTileRemoved(tile);
+    removeTileCoverage(tile);
+    notifyObservers(floorplanEventType::TILE_DELETED, tile, tile->getRectangle(), {}, true);
     tileType toDeleteType = tile->getType();
     // if(!((toDeleteType == tileType::BLOCK) || (toDeleteType == tileType::OVERLAP))){
     //     throw CSException("FLOORPLAN_06");
     // }
     // clean-up the payload information stored inside the floorplan system
     if(toDeleteType == tileType::BLOCK){
-        std::unordered_map<Tile *, Rectilinear *>::iterator blockIt= this->blockTilePayload.find(tile);
-        // if(blockIt == this->blockTilePayload.end()){
-        //     throw CSException("FLOORPLAN_07");
-        // }
         // erase the tile from the rectilinear structure
-        Rectilinear *rt = blockIt->second;
+        Rectilinear *rt = tile->mBlockPayload;
         rt->blockTiles.erase(tile);
-        // erase the payload from the floorplan structure
-        this->blockTilePayload.erase(tile);
+        // erase the payload from the tile
+        tile->mBlockPayload = nullptr;
     }else{
-        std::unordered_map<Tile *, std::vector<Rectilinear *>>::iterator overlapIt = this->overlapTilePayload.find(tile);
-        // if(overlapIt == this->overlapTilePayload.end()){
-        //     throw CSException("FLOORPLAN_08");
-        // }
-
         // erase the tiles from the rectiliear structures
-        for(Rectilinear *const rt : overlapIt->second){
+        for(Rectilinear *const rt : tile->mOverlapPayload){
             rt->overlapTiles.erase(tile);
         }
 
-        // erase the payload from the floorplan structure
-        this->overlapTilePayload.erase(tile);
+        // erase the payload from the tile
+        tile->mOverlapPayload.clear();
     }
 
     // remove the tile from the cornerStitching structure
@@ -697,48 +1201,42 @@ void Floorplan::increaseTileOverlap(Tile *tile, Rectilinear *newRect){
     //     throw CSException("FLOORPLAN_26");
     // }  
     tileType increaseTileType = tile->getType();
+    if(increaseTileType != tileType::BLANK) logTilePayloadChanged(tile);
+    std::vector<Rectilinear *> oldPayload;
+    collectTilePayload(tile, oldPayload);
 
     if(increaseTileType == tileType::BLOCK){
-        // check if the tile is present in the floorplan structure
-        std::unordered_map<Tile *, Rectilinear *>::iterator blockIt = this->blockTilePayload.find(tile);
-        // if(blockIt == this->blockTilePayload.end()){
-        //     throw CSException("FLOORPLAN_09");
-        // }
-
-        // if(blockIt->second == newRect){
+        // if(tile->mBlockPayload == newRect){
         //     throw CSException("FLOORPLAN_20");
         // }
 
-        Rectilinear *oldRect = blockIt->second;
-        // erase record at floorplan system and rectilinear system
-        this->blockTilePayload.erase(tile);
+        Rectilinear *oldRect = tile->mBlockPayload;
+        // erase record at the tile and rectilinear system
+        tile->mBlockPayload = nullptr;
         oldRect->blockTiles.erase(tile);
 
         // change the tile's type attribute 
-        tile->setType(tileType::OVERLAP);
+        retypeTile(tile, tileType::OVERLAP);
 
         // refill correct information for floorplan system and rectilinear
-        this->overlapTilePayload[tile] = {oldRect, newRect};
+        tile->mOverlapPayload = {oldRect, newRect};
         oldRect->overlapTiles.insert(tile);
         newRect->overlapTiles.insert(tile);
 
     }else if(increaseTileType == tileType::OVERLAP){
-        std::unordered_map<Tile *, std::vector<Rectilinear *>>::iterator overlapIt = this->overlapTilePayload.find(tile);
-        // if(overlapIt == this->overlapTilePayload.end()){
-        //     throw CSException("FLOORPLAN_10");
-        // }
-
-        // if(std::find(overlapIt->second.begin(), overlapIt->second.end(), newRect) != overlapIt->second.end()){
+        // if(std::find(tile->mOverlapPayload.begin(), tile->mOverlapPayload.end(), newRect) != tile->mOverlapPayload.end()){
         //     throw CSException("FLOORPLAN_20");
         // }
         
         // update newRect's rectilienar structure and register newRect as tile's payload at floorplan system
         newRect->overlapTiles.insert(tile);
-        this->overlapTilePayload[tile].push_back(newRect);
+        tile->mOverlapPayload.push_back(newRect);
 
     }else{
         throw CSException("FLOORPLAN_11");
     }
+    addCoveredRegion(newRect, tile->getRectangle());
+    notifyObservers(floorplanEventType::PAYLOAD_CHANGED, tile, tile->getRectangle(), oldPayload, true);
 }
 
 void Floorplan::decreaseTileOverlap(Tile *tile, Rectilinear *removeRect){
@@ -746,34 +1244,32 @@ void Floorplan::decreaseTileOverlap(Tile *tile, Rectilinear *removeRect){
     //     throw CSException("FLOORPLAN_12");
     // }
 
-    // if(this->overlapTilePayload.find(tile) == this->overlapTilePayload.end()){
-    //     throw CSException("FLOORPLAN_13");
-    // }
-
-    std::vector<Rectilinear *> *oldPayload = &(this->overlapTilePayload[tile]);
+    OverlapPayload *oldPayload = &(tile->mOverlapPayload);
     // if(std::find(oldPayload->begin(), oldPayload->end(), removeRect) == oldPayload->end()){
     //     throw CSException("FLOORPLAN_14");
     // }
     int oldPayloadSize = oldPayload->size();
+    if(oldPayloadSize >= 2) logTilePayloadChanged(tile);
+    std::vector<Rectilinear *> removedPayload = oldPayload->toVector();
     if(oldPayloadSize == 2){
         // ready to change tile's type to tileType::BLOCK
         Rectilinear *solePayload = (((*oldPayload)[0]) == removeRect)? ((*oldPayload)[1]) : ((*oldPayload)[0]);
-        // remove tile payload from floorplan structure
-        this->overlapTilePayload.erase(tile);
+        // remove tile payload from the tile
+        tile->mOverlapPayload.clear();
 
         // remove from rectilinear structure
         removeRect->overlapTiles.erase(tile);
         solePayload->overlapTiles.erase(tile);
 
         // change type of the tile
-        tile->setType(tileType::BLOCK);
+        retypeTile(tile, tileType::BLOCK);
 
         solePayload->blockTiles.insert(tile);
-        this->blockTilePayload[tile] = solePayload;
+        tile->mBlockPayload = solePayload;
     }else if(oldPayloadSize > 2){
         // the tile has 2 or more rectilinear after removal, keep type as tileType::OVERLAP
 
-        std::vector<Rectilinear *> *toChange = &(this->overlapTilePayload[tile]);
+        OverlapPayload *toChange = &(tile->mOverlapPayload);
         // apply erase-remove idiom to delete removeRect from the payload from floorplan 
         toChange->erase(std::remove(toChange->begin(), toChange->end(), removeRect));
 
@@ -782,6 +1278,8 @@ void Floorplan::decreaseTileOverlap(Tile *tile, Rectilinear *removeRect){
     }else{
         throw CSException("FLOORPLAN_15");
     }
+    removeCoveredRegion(removeRect, tile->getRectangle());
+    notifyObservers(floorplanEventType::PAYLOAD_CHANGED, tile, tile->getRectangle(), removedPayload, true);
 }
 
 void Floorplan::reshapeRectilinear(Rectilinear *rt){
@@ -811,6 +1309,8 @@ void Floorplan::reshapeRectilinear(Rectilinear *rt){
         }
     }
 
+    // blank tiles freed by the deletions are merged once after the new tiles are in place
+    cs->beginBatch();
     for(std::unordered_map<Rectangle, Tile*>::iterator it = rectanglesToDelete.begin(); it != rectanglesToDelete.end(); ++it){
         deleteTile(it->second);
     }
@@ -818,9 +1318,85 @@ void Floorplan::reshapeRectilinear(Rectilinear *rt){
     for(Rectangle const &toAddRect : rectanglesToAdd){
         addBlockTile(toAddRect, rt);
     }
+    cs->endBatch();
 
 }
 
+void Floorplan::compactTiles(size_t &tileCountBefore, size_t &tileCountAfter){
+    tileCountBefore = this->cs->getNonBlankTiles().size();
+
+    // visit dirty rectilinears by id so the resulting tiles do not depend on pointer values
+    std::vector<Rectilinear *> dirtyRects(this->mCompactionDirty.begin(), this->mCompactionDirty.end());
+    std::sort(dirtyRects.begin(), dirtyRects.end(), [](Rectilinear *a, Rectilinear *b){ return a->getId() < b->getId(); });
+
+    // an overlap payload is shared by several rectilinears, compact each payload only once
+    std::set<std::vector<int>> compactedPayloads;
+
+    mCompactingTiles = true;
+    cs->beginBatch();
+    for(Rectilinear *const &rt : dirtyRects){
+        std::vector<Tile *> blockTiles(rt->blockTiles.begin(), rt->blockTiles.end());
+        compactTileGroup(blockTiles, {rt});
+
+        std::map<std::vector<int>, std::vector<Tile *>> overlapGroups;
+        std::map<std::vector<int>, std::vector<Rectilinear *>> overlapGroupPayloads;
+        for(Tile *const &overlapTile : rt->overlapTiles){
+            std::vector<Rectilinear *> payload = overlapTile->getOverlapPayload().toVector();
+            std::sort(payload.begin(), payload.end(), [](Rectilinear *a, Rectilinear *b){ return a->getId() < b->getId(); });
+            std::vector<int> payloadIds;
+            for(Rectilinear *const &payloadRect : payload){
+                payloadIds.push_back(payloadRect->getId());
+            }
+            if(compactedPayloads.find(payloadIds) != compactedPayloads.end()) continue;
+
+            overlapGroups[payloadIds].push_back(overlapTile);
+            overlapGroupPayloads[payloadIds] = payload;
+        }
+
+        for(std::map<std::vector<int>, std::vector<Tile *>>::iterator it = overlapGroups.begin(); it != overlapGroups.end(); ++it){
+            compactedPayloads.insert(it->first);
+            compactTileGroup(it->second, overlapGroupPayloads[it->first]);
+        }
+    }
+    cs->endBatch();
+    mCompactingTiles = false;
+
+    this->mCompactionDirty.clear();
+    tileCountAfter = this->cs->getNonBlankTiles().size();
+}
+
+void Floorplan::relayoutTiles(){
+    std::unordered_map<Tile *, Tile *> tileMap;
+    cs->relayoutTiles(tileMap);
+    if(tileMap.empty()) return;
+
+    // the relocated tiles carry their payload along, only the tile sets of the rectilinears need the new pointers (observers get TILE_RELOCATED)
+
+    for(Rectilinear *const &rt : this->allRectilinears){
+        TileList newBlockTiles;
+        newBlockTiles.reserve(rt->blockTiles.size());
+        for(Tile *const &oldT : rt->blockTiles){
+            newBlockTiles.insert(tileMap[oldT]);
+        }
+        rt->blockTiles.swap(newBlockTiles);
+
+        TileList newOverlapTiles;
+        newOverlapTiles.reserve(rt->overlapTiles.size());
+        for(Tile *const &oldT : rt->overlapTiles){
+            newOverlapTiles.insert(tileMap[oldT]);
+        }
+        rt->overlapTiles.swap(newOverlapTiles);
+    }
+
+    for(std::pair<Tile *const, Tile *> const &relocation : tileMap){
+        Tile *newTile = relocation.second;
+        if(newTile->getType() == tileType::BLANK) continue;
+        FloorplanEvent event = {floorplanEventType::TILE_RELOCATED, newTile, newTile->getRectangle(), newTile->getRectangle(), {}, {}, relocation.first};
+        collectTilePayload(newTile, event.rectilinears);
+        dispatchEvent(event);
+    }
+}
+
 void Floorplan::growRectilinear(std::vector<DoughnutPolygon> &toGrow, Rectilinear *rect){
     using namespace boost::polygon::operators;
     DoughnutPolygonSet growPart;
@@ -853,6 +1429,8 @@ void Floorplan::growRectilinear(std::vector<DoughnutPolygon> &toGrow, Rectilinea
         }
     }
 
+    // blank tiles freed by the deletions are merged once after the new tiles are in place
+    cs->beginBatch();
     for(std::unordered_map<Rectangle, Tile*>::iterator it = rectanglesToDelete.begin(); it != rectanglesToDelete.end(); ++it){
         deleteTile(it->second);
     }
@@ -860,6 +1438,7 @@ void Floorplan::growRectilinear(std::vector<DoughnutPolygon> &toGrow, Rectilinea
     for(Rectangle const &toAddRect : rectanglesToAdd){
         addBlockTile(toAddRect, rect);
     }
+    cs->endBatch();
 
 }
 
@@ -895,6 +1474,8 @@ void Floorplan::shrinkRectilinear(std::vector<DoughnutPolygon> &toShrink, Rectil
         }
     }
 
+    // blank tiles freed by the deletions are merged once after the new tiles are in place
+    cs->beginBatch();
     for(std::unordered_map<Rectangle, Tile*>::iterator it = rectanglesToDelete.begin(); it != rectanglesToDelete.end(); ++it){
         deleteTile(it->second);
     }
@@ -902,26 +1483,40 @@ void Floorplan::shrinkRectilinear(std::vector<DoughnutPolygon> &toShrink, Rectil
     for(Rectangle const &toAddRect : rectanglesToAdd){
         addBlockTile(toAddRect, rect);
     }
+    cs->endBatch();
 
 }
 
 Tile *Floorplan::divideTileHorizontally(Tile *origTop, len_t newDownHeight){
     switch (origTop->getType()){
     case tileType::BLOCK:{
-        Rectilinear *origTopBelongRect = this->blockTilePayload[origTop];
+        Rectilinear *origTopBelongRect = origTop->getBlockPayload();
+        Rectangle origRectangle = origTop->getRectangle();
+        logTileRemoved(origTop);
         Tile *newDown = cs->cutTileHorizontally(origTop, newDownHeight);
+        // the cut piece comes back without payload, attach it before logging so it is journalled & marked under its rectilinear
         origTopBelongRect->blockTiles.insert(newDown);
-        this->blockTilePayload[newDown] = origTopBelongRect;
+        newDown->mBlockPayload = origTopBelongRect;
+        logTileAdded(origTop);
+        logTileAdded(newDown);
+        notifyObservers(floorplanEventType::TILE_RESIZED, origTop, origRectangle, {}, false);
+        notifyObservers(floorplanEventType::TILE_CREATED, newDown, newDown->getRectangle(), {}, false);
         return newDown;
         break;
     }
     case tileType::OVERLAP:{
-        std::vector<Rectilinear *> origTopContainedRect(this->overlapTilePayload[origTop]);
+        OverlapPayload origTopContainedRect(origTop->getOverlapPayload());
+        Rectangle origRectangle = origTop->getRectangle();
+        logTileRemoved(origTop);
         Tile *newDown = cs->cutTileHorizontally(origTop, newDownHeight);
         for(Rectilinear *const &rect : origTopContainedRect){
             rect->overlapTiles.insert(newDown);
         }
-        this->overlapTilePayload[newDown] = origTopContainedRect;
+        newDown->mOverlapPayload = origTopContainedRect;
+        logTileAdded(origTop);
+        logTileAdded(newDown);
+        notifyObservers(floorplanEventType::TILE_RESIZED, origTop, origRectangle, {}, false);
+        notifyObservers(floorplanEventType::TILE_CREATED, newDown, newDown->getRectangle(), {}, false);
         return newDown;
         break;
     }
@@ -934,20 +1529,33 @@ Tile *Floorplan::divideTileHorizontally(Tile *origTop, len_t newDownHeight){
 Tile *Floorplan::divideTileVertically(Tile *origRight, len_t newLeftWidth){
     switch (origRight->getType()){
     case tileType::BLOCK:{
-        Rectilinear *origTopBelongRect = this->blockTilePayload[origRight];
+        Rectilinear *origTopBelongRect = origRight->getBlockPayload();
+        Rectangle origRectangle = origRight->getRectangle();
+        logTileRemoved(origRight);
         Tile *newDown = cs->cutTileVertically(origRight, newLeftWidth);
+        // the cut piece comes back without payload, attach it before logging so it is journalled & marked under its rectilinear
         origTopBelongRect->blockTiles.insert(newDown);
-        this->blockTilePayload[newDown] = origTopBelongRect;
+        newDown->mBlockPayload = origTopBelongRect;
+        logTileAdded(origRight);
+        logTileAdded(newDown);
+        notifyObservers(floorplanEventType::TILE_RESIZED, origRight, origRectangle, {}, false);
+        notifyObservers(floorplanEventType::TILE_CREATED, newDown, newDown->getRectangle(), {}, false);
         return newDown;
         break;
     }
     case tileType::OVERLAP:{
-        std::vector<Rectilinear *> origTopContainedRect(this->overlapTilePayload[origRight]);
+        OverlapPayload origTopContainedRect(origRight->getOverlapPayload());
+        Rectangle origRectangle = origRight->getRectangle();
+        logTileRemoved(origRight);
         Tile *newDown = cs->cutTileVertically(origRight, newLeftWidth);
         for(Rectilinear *const &rect : origTopContainedRect){
             rect->overlapTiles.insert(newDown);
         }
-        this->overlapTilePayload[newDown] = origTopContainedRect;
+        newDown->mOverlapPayload = origTopContainedRect;
+        logTileAdded(origRight);
+        logTileAdded(newDown);
+        notifyObservers(floorplanEventType::TILE_RESIZED, origRight, origRectangle, {}, false);
+        notifyObservers(floorplanEventType::TILE_CREATED, newDown, newDown->getRectangle(), {}, false);
         return newDown;
         break;
     }
@@ -958,10 +1566,89 @@ Tile *Floorplan::divideTileVertically(Tile *origRight, len_t newLeftWidth){
 
 }
 
+size_t Floorplan::takeSnapshot(){
+    ++mLiveSnapshotCount;
+    return mJournal.size();
+}
+
+void Floorplan::restoreSnapshot(size_t snapshot){
+    if((mLiveSnapshotCount == 0) || (snapshot > mJournal.size())){
+        throw CSException("FLOORPLAN_28");
+    }
+
+    undoJournalTo(snapshot);
+}
+
+void Floorplan::releaseSnapshot(size_t snapshot){
+    if((mLiveSnapshotCount == 0) || (snapshot > mJournal.size())){
+        throw CSException("FLOORPLAN_28");
+    }
+
+    --mLiveSnapshotCount;
+    trimJournal();
+}
+
+void Floorplan::beginTransaction(){
+    mTransactionMarks.push_back(mJournal.size());
+}
+
+void Floorplan::commit(){
+    if(mTransactionMarks.empty()){
+        throw CSException("FLOORPLAN_30");
+    }
+
+    mTransactionMarks.pop_back();
+    trimJournal();
+}
+
+void Floorplan::rollback(){
+    if(mTransactionMarks.empty()){
+        throw CSException("FLOORPLAN_30");
+    }
+
+    undoJournalTo(mTransactionMarks.back());
+    mTransactionMarks.pop_back();
+    trimJournal();
+}
+
 double Floorplan::calculateHPWL() const{
+    int connectionCount = this->allConnections.size();
+    std::vector<int> dirtyConnections;
+
+    if(int(this->mHPWLConnectionCosts.size()) != connectionCount){
+        // (re)build the cache, every connected rectilinear is dirty and every connection is evaluated
+        this->mHPWLRectilinearConnections.clear();
+        this->mHPWLCentres.clear();
+        for(int c = 0; c < connectionCount; ++c){
+            for(Rectilinear *const &rt : this->allConnections[c]->vertices){
+                this->mHPWLRectilinearConnections[rt].push_back(c);
+                this->mHPWLDirty.insert(rt);
+            }
+        }
+        this->mHPWLConnectionCosts.assign(connectionCount, 0);
+    }
+
+    for(Rectilinear *const &rt : this->mHPWLDirty){
+        std::unordered_map<Rectilinear *, std::vector<int>>::const_iterator it = this->mHPWLRectilinearConnections.find(rt);
+        if(it == this->mHPWLRectilinearConnections.end()) continue;
+
+        double centreX, centreY;
+        rec::calculateCentre(rt->calculateBoundingBox(), centreX, centreY);
+        this->mHPWLCentres[rt] = FCord(centreX, centreY);
+        dirtyConnections.insert(dirtyConnections.end(), it->second.begin(), it->second.end());
+    }
+    this->mHPWLDirty.clear();
+
+    std::sort(dirtyConnections.begin(), dirtyConnections.end());
+    dirtyConnections.erase(std::unique(dirtyConnections.begin(), dirtyConnections.end()), dirtyConnections.end());
+    for(int const &c : dirtyConnections){
+        this->mHPWLConnectionCosts[c] = evaluateConnectionCost(c);
+    }
+
+    // sum in connection order so the result is bit-identical to evaluating every connection
     double floorplanHPWL = 0;
-    for(Connection *const &c : this->allConnections){
-        floorplanHPWL += c->calculateCost();
+    for(double const &cost : this->mHPWLConnectionCosts){
+        floorplanHPWL += cost;
     }
     
     return floorplanHPWL;
@@ -1151,6 +1838,10 @@ bool Floorplan::calculateRectilinearGradient(Rectilinear *rect, EVector &gradien
 
 }
 
+size_t Floorplan::getOverlapTileCount() const {
+    return this->mOverlapTileCount;
+}
+
 double Floorplan::calculateOverlapRatio() const {
     area_t sumLegalArea = 0;
     area_t sumOverlapArea = 0;
@@ -1159,8 +1850,9 @@ double Floorplan::calculateOverlapRatio() const {
         sumLegalArea += rt->getLegalArea();
     }
 
-    for(std::unordered_map<Tile *, std::vector<Rectilinear *>>::const_iterator it = overlapTilePayload.begin(); it != overlapTilePayload.end(); ++it){
-        sumOverlapArea += (it->first->getArea() * it->second.size());
+    for(Tile *const &tile : this->cs->getNonBlankTiles()){
+        if(tile->getType() != tileType::OVERLAP) continue;
+        sumOverlapArea += (tile->getArea() * tile->getOverlapPayload().size());
     }
 
     return double(sumOverlapArea) / double(sumLegalArea);
@@ -1420,7 +2112,7 @@ double Floorplan::calculateOverlapRatio() const {
 //                 if(verbose) std::cout << " (" << beforeArea << " -> " << beforeArea - removeTileArea << ")" << std::endl;
 //                 decreaseTileOverlap(removeTile, removeRT);
 //                 if(removeTile->getType() == tileType::BLOCK){
-//                     reshapeRectilinear(this->blockTilePayload[removeTile]);
+//                     reshapeRectilinear(removeTile->getBlockPayload());
 //                 }
 //             }
 
@@ -1434,39 +2126,47 @@ double Floorplan::calculateOverlapRatio() const {
 
 Rectilinear *Floorplan::checkFloorplanLegal(rectilinearIllegalType &illegalType) const {
     // check if there is overlap tile
-    if(!overlapTilePayload.empty()){
-        illegalType = rectilinearIllegalType::OVERLAP;
-        return overlapTilePayload.begin()->second.at(0);
+    if(this->mOverlapTileCount > 0){
+        for(Tile *const &tile : this->cs->getNonBlankTiles()){
+            if(tile->getType() == tileType::OVERLAP){
+                illegalType = rectilinearIllegalType::OVERLAP;
+                return tile->getOverlapPayload()[0];
+            }
+        }
     }
 
-    using namespace boost::polygon::operators;
-    // check if preplacedRecilinears are all legal
-    for(Rectilinear *const &rt : preplacedRectilinears){
-        DoughnutPolygonSet currentShape;
-        for(Tile *const &fragment : rt->blockTiles){
-            currentShape += fragment->getRectangle();
+    // bring the cached verdicts of preplacedRectilinears & softRectilinears up to date
+    size_t preplacedCount = this->preplacedRectilinears.size();
+    size_t rectCount = preplacedCount + this->softRectilinears.size();
+    if(this->mLegalityVerdicts.size() != rectCount){
+        this->mLegalityOrder.clear();
+        for(size_t i = 0; i < preplacedCount; ++i){
+            this->mLegalityOrder[this->preplacedRectilinears[i]] = i;
         }
-        std::vector<Rectangle> diceResult;
-        dps::diceIntoRectangles(currentShape, diceResult);
-        if (diceResult.size() == 1){
-            if(diceResult[0] != rt->getGlboalPlacement()){
-                illegalType = rectilinearIllegalType::PREPLACE_FAIL;
-                return rt;
-            }
-        }else{
-            illegalType = rectilinearIllegalType::PREPLACE_FAIL;
-            return rt;
+        for(size_t i = preplacedCount; i < rectCount; ++i){
+            this->mLegalityOrder[this->softRectilinears[i - preplacedCount]] = i;
+        }
+        this->mLegalityVerdicts.assign(rectCount, rectilinearIllegalType::LEGAL);
+        this->mIllegalPositions.clear();
+        for(size_t i = 0; i < rectCount; ++i){
+            refreshLegality(i);
+        }
+    }else{
+        for(Rectilinear *const &rt : this->mLegalityDirty){
+            std::unordered_map<Rectilinear *, int>::const_iterator it = this->mLegalityOrder.find(rt);
+            if(it != this->mLegalityOrder.end()) refreshLegality(it->second);
         }
     }
+    this->mLegalityDirty.clear();
 
-    // check if softRectilinears are all legal
-    for(Rectilinear *const &rt : softRectilinears){
-        if(!(rt->isLegal(illegalType))) return rt;
+    if(this->mIllegalPositions.empty()){
+        illegalType = rectilinearIllegalType::LEGAL;
+        return nullptr;
     }
 
-    illegalType = rectilinearIllegalType::LEGAL;
-    return nullptr;
-
+    int firstIllegal = *(this->mIllegalPositions.begin());
+    illegalType = this->mLegalityVerdicts[firstIllegal];
+    return (size_t(firstIllegal) < preplacedCount)? this->preplacedRectilinears[firstIllegal] : this->softRectilinears[firstIllegal - preplacedCount];
 }
 
 bool Floorplan::debugFloorplanLegal() const{
@@ -1568,8 +2268,8 @@ void Floorplan::visualiseRectiFloorplan(const std::string &outputFileName) const
         // case where zero area rectilinear
         if (rect->getLegalArea() == 0){
             ofs << rect->getName() << " 4" << std::endl;  
-            int x = rec::getXL(rect->getGlboalPlacement());
-            int y = rec::getYL(rect->getGlboalPlacement());
+            len_t x = rec::getXL(rect->getGlboalPlacement());
+            len_t y = rec::getYL(rect->getGlboalPlacement());
             ofs << x << ' ' << y << std::endl;
             ofs << x << ' ' << y << std::endl;
             ofs << x << ' ' << y << std::endl;
@@ -1863,17 +2563,22 @@ void Floorplan::visualiseICCADFormat(const std::string &outputFileName) const {
 }
 
 void Floorplan::moveTileParent(Tile* tile, Rectilinear* fromRect, Rectilinear* toRect){
-    std::unordered_map<Tile *, Rectilinear *>::iterator blockIt= this->blockTilePayload.find(tile);
-    if(blockIt == this->blockTilePayload.end() || blockIt->second != fromRect){
+    if(tile->getType() != tileType::BLOCK || tile->mBlockPayload != fromRect){
         std::cerr << "Error: in moveTileParent, tile not found in original parent\n";
     }
 
+    logTilePayloadChanged(tile);
+    // the tile may now merge with toRect's tiles
+    this->mCompactionDirty.insert(toRect);
+    removeCoveredRegion(fromRect, tile->getRectangle());
+    addCoveredRegion(toRect, tile->getRectangle());
     // remove from fromRect's blockTiles
     fromRect->blockTiles.erase(tile);
     // change tile's payload to new rectilinear parent
-    this->blockTilePayload[tile] = toRect;
+    tile->mBlockPayload = toRect;
     // add to toRect's blockTiles
     toRect->blockTiles.insert(tile);
+    notifyObservers(floorplanEventType::PAYLOAD_CHANGED, tile, tile->getRectangle(), {fromRect}, true);
 }
 
 // added by ryan
@@ -1883,25 +2588,41 @@ Tile* Floorplan::generalSplitTile(Tile* tile, Rectangle newArea){
     
     switch (tile->getType()){
         case tileType::BLOCK:{
-            Rectilinear *originalBelongRecti = this->blockTilePayload[tile];
+            Rectilinear *originalBelongRecti = tile->getBlockPayload();
+            Rectangle originalRectangle = tile->getRectangle();
+            logTileRemoved(tile);
             centerTile = this->cs->generalSplitTile(tile, newArea, newNeighbors);
 
             for (Tile* newTile: newNeighbors){
                 originalBelongRecti->blockTiles.insert(newTile);
-                this->blockTilePayload[newTile] = originalBelongRecti;
+                newTile->mBlockPayload = originalBelongRecti;
+                logTileAdded(newTile);
+            }
+            logTileAdded(centerTile);
+            notifyObservers(floorplanEventType::TILE_RESIZED, centerTile, originalRectangle, {}, false);
+            for (Tile* newTile: newNeighbors){
+                notifyObservers(floorplanEventType::TILE_CREATED, newTile, newTile->getRectangle(), {}, false);
             }
 
             return centerTile;
         }
         case tileType::OVERLAP:{
-            std::vector<Rectilinear *> orignalBelongRectis(this->overlapTilePayload[tile]);
+            OverlapPayload orignalBelongRectis(tile->getOverlapPayload());
+            Rectangle originalRectangle = tile->getRectangle();
+            logTileRemoved(tile);
             centerTile = this->cs->generalSplitTile(tile, newArea, newNeighbors);
 
             for (Tile* newTile: newNeighbors){
                 for (Rectilinear* const& rect: orignalBelongRectis){
                     rect->overlapTiles.insert(newTile);
                 }
-                this->overlapTilePayload[newTile] = orignalBelongRectis;
+                newTile->mOverlapPayload = orignalBelongRectis;
+                logTileAdded(newTile);
+            }
+            logTileAdded(centerTile);
+            notifyObservers(floorplanEventType::TILE_RESIZED, centerTile, originalRectangle, {}, false);
+            for (Tile* newTile: newNeighbors){
+                notifyObservers(floorplanEventType::TILE_CREATED, newTile, newTile->getRectangle(), {}, false);
             }
             
             return centerTile;
@@ -1915,6 +2636,21 @@ Tile* Floorplan::generalSplitTile(Tile* tile, Rectangle newArea){
     }
 }
 
+void FloorplanEventLog::onFloorplanEvent(const FloorplanEvent &event){
+    this->events.push_back(event);
+}
+
+FloorplanCacheInvalidator::FloorplanCacheInvalidator(Floorplan *floorplan)
+    : mFloorplan(floorplan) {
+}
+
+void FloorplanCacheInvalidator::onFloorplanEvent(const FloorplanEvent &event){
+    for(Rectilinear *const &rt : event.reshapedRectilinears){
+        mFloorplan->mHPWLDirty.insert(rt);
+        mFloorplan->mLegalityDirty.insert(rt);
+    }
+}
+
 size_t std::hash<Floorplan>::operator()(const Floorplan &key) const {
     return std::hash<Rectangle>()(key.getChipContour()) ^ std::hash<int>()(key.getAllRectilinearCount()) ^ std::hash<int>()(key.getConnectionCount());
 }
@@ -3,6 +3,8 @@
 
 #include <string.h>
 #include <unordered_map>
+#include <unordered_set>
+#include <set>
 
 #include "tile.h"
 #include "lineTile.h"
@@ -15,7 +17,72 @@
 #include "doughnutPolygonSet.h"
 #include "eVector.h"
 
+enum class journalEntryType{
+    TILE_ADDED, TILE_REMOVED, TILE_PAYLOAD_CHANGED
+};
+
+// One inverse edit inside the Floorplan edit journal. Tiles are recorded by geometry (not pointer) since
+// undoing edits re-creates tiles. oldTileType & oldPayload describe the tile before the edit (unused for TILE_ADDED)
+struct FloorplanJournalEntry{
+    journalEntryType type;
+    Rectangle tileRectangle;
+    tileType oldTileType;
+    std::vector<Rectilinear *> oldPayload;
+};
+
+enum class floorplanEventType{
+    TILE_CREATED, TILE_DELETED, TILE_RESIZED, PAYLOAD_CHANGED, TILE_RELOCATED
+};
+
+// One change reported to the observers of a Floorplan. tileRectangle is the tile's geometry after the change (TILE_DELETED is reported
+// right before the tile is freed), oldTileRectangle the geometry before a TILE_RESIZED. rectilinears are the rectilinears the change
+// touches, for PAYLOAD_CHANGED both the old and the new payload. reshapedRectilinears are those whose covered region grows or shrinks:
+// empty when tiles are only divided among the same payload (TILE_RESIZED and the TILE_CREATED of the new pieces), re-diced by
+// compactTiles() or relocated.
+// TILE_RELOCATED is reported for every nonblank tile moved by relayoutTiles(), oldTile is its freed former address (nullptr otherwise)
+struct FloorplanEvent{
+    floorplanEventType type;
+    Tile *tile;
+    Rectangle tileRectangle;
+    Rectangle oldTileRectangle;
+    std::vector<Rectilinear *> rectilinears;
+    std::vector<Rectilinear *> reshapedRectilinears;
+    Tile *oldTile;
+};
+
+// Interface for caches and incremental engines that follow the edits of a Floorplan, register through Floorplan::addObserver().
+// onFloorplanEvent() is called synchronously by every primitive edit
+class FloorplanObserver{
+public:
+    virtual ~FloorplanObserver() = default;
+    virtual void onFloorplanEvent(const FloorplanEvent &event) = 0;
+};
+
+// FloorplanObserver that keeps every event in order, for callers that would rather poll the changes
+class FloorplanEventLog : public FloorplanObserver{
+public:
+    std::vector<FloorplanEvent> events;
+
+    void onFloorplanEvent(const FloorplanEvent &event) override;
+};
+
+class Floorplan;
+
+// FloorplanObserver feeding the incremental HPWL & legality caches of a Floorplan: the reshapedRectilinears of every event are marked
+// for re-evaluation. Each Floorplan owns one, registered as its first observer
+class FloorplanCacheInvalidator : public FloorplanObserver{
+private:
+    Floorplan *mFloorplan;
+
+public:
+    explicit FloorplanCacheInvalidator(Floorplan *floorplan);
+
+    void onFloorplanEvent(const FloorplanEvent &event) override;
+};
+
 class Floorplan{
+    friend class FloorplanCacheInvalidator;
+
 private:
     int mIDCounter;
 
@@ -32,6 +99,92 @@ private:
     double mGlobalAspectRatioMax;
     double mGlobalUtilizationMin;
     
+    // Edit journal, while any snapshot or transaction is alive every primitive edit appends its inverse into mJournal
+    int mLiveSnapshotCount;
+    std::vector<size_t> mTransactionMarks;
+    bool mJournalReplaying;
+    std::vector<FloorplanJournalEntry> mJournal;
+
+    // set while compactTiles() re-dices tiles, the edits keep every covered region so their events reshape nothing
+    bool mCompactingTiles;
+
+    // observers are not copied with the floorplan, assignment replaces the content without reporting events.
+    // mCacheInvalidator is the first observer of every floorplan (copies included), it is never removed
+    FloorplanCacheInvalidator mCacheInvalidator{this};
+    std::vector<FloorplanObserver *> mObservers{&mCacheInvalidator};
+
+    // rectilinears whose tiles were edited since the last compactTiles(), only their tiles are compacted
+    // (compaction is not plane-wide: tiles of a rectilinear nothing touched since are left as they are)
+    std::unordered_set<Rectilinear *> mCompactionDirty;
+
+    // Incremental HPWL, calculateHPWL() only re-evaluates the connections of rectilinears reshaped since its last call (see mCacheInvalidator).
+    // mHPWLConnectionCosts[i] caches the cost of allConnections[i], mHPWLCentres the bounding box centre of each connected rectilinear.
+    // The cache is rebuilt whenever its size disagrees with allConnections
+    mutable std::unordered_set<Rectilinear *> mHPWLDirty;
+    mutable std::unordered_map<Rectilinear *, FCord> mHPWLCentres;
+    mutable std::unordered_map<Rectilinear *, std::vector<int>> mHPWLRectilinearConnections;
+    mutable std::vector<double> mHPWLConnectionCosts;
+
+    // number of OVERLAP tiles on the plane, every primitive edit keeps it up to date through the log functions & retypeTile()
+    size_t mOverlapTileCount;
+
+    // Incremental legality, checkFloorplanLegal() only re-checks rectilinears reshaped since its last call (see mCacheInvalidator).
+    // Rectilinears are checked in order (preplacedRectilinears, then softRectilinears), mLegalityOrder gives the position of each,
+    // mLegalityVerdicts[i] caches the verdict at position i and mIllegalPositions the positions with an illegal verdict.
+    // The cache is rebuilt whenever its size disagrees with the rectilinear lists
+    mutable std::unordered_set<Rectilinear *> mLegalityDirty;
+    mutable std::unordered_map<Rectilinear *, int> mLegalityOrder;
+    mutable std::vector<rectilinearIllegalType> mLegalityVerdicts;
+    mutable std::set<int> mIllegalPositions;
+
+    // place all rects (rects[i] at placements[i]) onto an empty floorplan at once. A y-sweep groups overlapping rectilinears into clusters,
+    // the one-by-one insertion of placeRectilinear is replayed per cluster on plain rectangles (same tiles, same payload order),
+    // singly covered parts are diced into block tiles as reshapeRectilinear would. The tiles are bulk-loaded into the cornerStitching system
+    void bulkPlaceRectilinears(const std::vector<Rectilinear *> &rects, const std::vector<Rectangle> &placements);
+
+    // record the payload of tile into mCompactionDirty, every primitive edit reports its tiles through the log functions below
+    void markCompactionDirty(Tile *tile);
+    // re-dice tiles (all carry the same payload) into maximal strips, only applied if it lowers the tile count
+    void compactTileGroup(const std::vector<Tile *> &tiles, const std::vector<Rectilinear *> &payload);
+
+    // the tiles of rt start/stop covering tileRectangle: keep rt's area & bounding box up to date (the caches learn it from the events).
+    // Called by every edit that changes the region a rectilinear covers, dividing a tile among the same payload needs no call
+    void addCoveredRegion(Rectilinear *rt, const Rectangle &tileRectangle);
+    void removeCoveredRegion(Rectilinear *rt, const Rectangle &tileRectangle);
+    // addCoveredRegion()/removeCoveredRegion() of every rectilinear in the payload of tile, over the whole tile
+    void addTileCoverage(Tile *tile);
+    void removeTileCoverage(Tile *tile);
+    // cost of allConnections[connectionIdx] from the cached centres, same arithmetic (and result) as Connection::calculateCost()
+    double evaluateConnectionCost(int connectionIdx) const;
+    // copy the HPWL cache of other, rectMap pairs other's rectilinears with the ones of this floorplan
+    void copyHPWLCache(const Floorplan &other, const std::unordered_map<Rectilinear *, Rectilinear *> &rectMap);
+    // re-check the rectilinear at position of the legality check order and update mLegalityVerdicts & mIllegalPositions
+    void refreshLegality(int position) const;
+    // copy the legality cache of other, rectMap pairs other's rectilinears with the ones of this floorplan
+    void copyLegalityCache(const Floorplan &other, const std::unordered_map<Rectilinear *, Rectilinear *> &rectMap);
+    // set the type of tile (BLOCK <-> OVERLAP), keeping mOverlapTileCount up to date
+    void retypeTile(Tile *tile, tileType type);
+
+    // push the payload of tile (BLOCK or OVERLAP) into payload
+    void collectTilePayload(Tile *tile, std::vector<Rectilinear *> &payload) const;
+    // build the event of an edit on tile and hand it to every observer, oldPayload is the payload before a PAYLOAD_CHANGED.
+    // reshaping tells whether the edit changes the region of the rectilinears (false when a tile is only divided among the same payload)
+    void notifyObservers(floorplanEventType type, Tile *tile, const Rectangle &oldTileRectangle, const std::vector<Rectilinear *> &oldPayload, bool reshaping);
+    void dispatchEvent(const FloorplanEvent &event);
+
+    bool isJournalling() const;
+    void logTileAdded(Tile *tile);
+    void logTileRemoved(Tile *tile);
+    void logTilePayloadChanged(Tile *tile);
+    void undoJournalEntry(const FloorplanJournalEntry &entry);
+    // undo journal entries (latest first) until the journal is position long
+    void undoJournalTo(size_t position);
+    // drop the journal if no snapshot or transaction needs it anymore
+    void trimJournal();
+
+    // function that registers a rectilinear into the floorplan system, no tiles are placed
+    Rectilinear *createRectilinear(std::string name, rectilinearType type, Rectangle placement, area_t legalArea, double aspectRatioMin, double aspectRatioMax, double mUtilizationMin);
+
     // function that places a rectilinear into the floorplan system. It automatically resolves overlaps by splittng and divide existing tiles
     Rectilinear *placeRectilinear(std::string name, rectilinearType type, Rectangle placement, area_t legalArea, double aspectRatioMin, double aspectRatioMax, double mUtilizationMin);
 
@@ -48,10 +201,8 @@ public:
 
     std::vector<Connection *> allConnections;
     std::unordered_map<Rectilinear *, std::vector<Connection *>> connectionMap;
-    
-    std::unordered_map<Tile *, Rectilinear *> blockTilePayload;
-    std::unordered_map<Tile *, std::vector<Rectilinear *>> overlapTilePayload;
 
+    // the payload of every tile is stored inside the tile, see Tile::getBlockPayload() & Tile::getOverlapPayload()
 
     Floorplan();
     Floorplan(const GlobalResult &gr, double aspectRatioMin, double aspectRatioMax, double utilizationMin);
@@ -75,12 +226,16 @@ public:
     void setGlobalAspectRatioMax(double globalAspectRatioMax);
     void setGlobalUtilizationMin(double globalUtilizationMin);
 
+    // observer receives an event for every tile created, deleted, resized, relocated or payload change from now on, until removeObserver()
+    void addObserver(FloorplanObserver *observer);
+    void removeObserver(FloorplanObserver *observer);
+
     // insert a tleType::BLOCK tile at tilePosition into cornerStitching & rectilinear (*rt) system,
-    // record rt as it's payload into floorplan system (into blockTilePayload) and return new tile's pointer
+    // record rt as it's payload into tile (Tile::getBlockPayload()) and return new tile's pointer
     Tile *addBlockTile(const Rectangle &tilePosition, Rectilinear *rt);
 
     // insert a tleType::OVERLAP tile at tilePosition into cornerStitching & rectilinear (•rt) system,
-    // record payload as it's payload into floorplan system (into overlapTilePayload) and return new tile's pointer
+    // record payload as it's payload into tile (Tile::getOverlapPayload()) and return new tile's pointer
     Tile *addOverlapTile(const Rectangle &tilePosition, const std::vector<Rectilinear*> &payload);
 
     // remove tile data payload at floorplan system, the rectilienar that records it and lastly remove from cornerStitching,
@@ -96,6 +251,16 @@ public:
     // collect all blocks within a rectilinear, reDice them into Rectangles. (potentially reduce Tile count)
     void reshapeRectilinear(Rectilinear *rt);
 
+    // merge the fragmented tiles of every rectilinear edited since the last call: block tiles of a rectilinear and overlap tiles
+    // sharing the same payload are re-diced into maximal strips. Only those rectilinears are visited, this is not a plane-wide pass.
+    // The re-dice keeps every covered region, its events carry no reshapedRectilinears so the HPWL & legality caches stay valid.
+    // Reports the non-blank tile count (whole plane) before and after compaction
+    void compactTiles(size_t &tileCountBefore, size_t &tileCountAfter);
+
+    // relocate the tiles along a space-filling curve (CornerStitching::relayoutTiles) and remap all payloads onto the relocated tiles.
+    // Tile pointers held outside the floorplan become invalid, only call between phases
+    void relayoutTiles();
+
     // grow the shape toGrow to the Rectilinear
     void growRectilinear(std::vector<DoughnutPolygon> &toGrow, Rectilinear *rect);
 
@@ -112,7 +277,26 @@ public:
     // 2. newLeft represents the left portion of the split, with width newLeftWidth, is the return value
     Tile *divideTileVertically(Tile *origRight, len_t newLeftWidth);
 
+    // Take an O(1) snapshot of the floorplan, the return value marks a position in the edit journal. While the snapshot is alive
+    // edits are journalled (memory grows with the amount of edits, not the size of the floorplan) and restoreSnapshot can bring it back.
+    // The snapshot is an undo journal, not a copy-on-write version: it holds tile geometry & payloads, never Tile pointers
+    size_t takeSnapshot();
+    // undo every edit made after snapshot, tile geometry and payloads become identical to the moment snapshot was taken.
+    // The tiles edited since the snapshot are re-created, so any Tile * obtained before the restore (including before the snapshot)
+    // may dangle afterwards: look tiles up again through the rectilinears or the plane. The snapshot stays alive
+    void restoreSnapshot(size_t snapshot);
+    // the snapshot is no longer needed, the journal is dropped once no snapshot is alive
+    void releaseSnapshot(size_t snapshot);
+
+    // Transactions on top of the edit journal, they may nest. Speculative edits cost only as much as the edit itself:
+    // rollback() undoes every edit since the matching beginTransaction(), commit() keeps them (an enclosing transaction can still undo).
+    // Like restoreSnapshot(), rollback() re-creates the tiles it undoes and invalidates Tile pointers obtained before it
+    void beginTransaction();
+    void commit();
+    void rollback();
+
     // calculate the HPWL (cost) of the floorplan system, using the connections information stored inside "allConnections"
+    // only connections touching rectilinears edited since the last call are re-evaluated, the result equals a full evaluation
     double calculateHPWL() const;
 
     // calculate the optimal centre of a soft rectilnear, return Cord(-1, -1) if no connection is present
@@ -122,11 +306,14 @@ public:
     bool calculateRectilinearGradient(Rectilinear *rect, EVector &gradient) const;
     
     double calculateOverlapRatio() const;
+    // number of OVERLAP tiles currently on the floorplan, O(1)
+    size_t getOverlapTileCount() const;
 
     // use area rounding residuals to remove certain easy to remove overlaps
     // void removePrimitiveOvelaps(bool verbose);
 
-    // check if the floorplan is legal, return nullptr if floorplan legal, otherwise return first met faulty Rectilinear
+    // check if the floorplan is legal, return nullptr if floorplan legal, otherwise return first met faulty Rectilinear.
+    // Verdicts are cached, only rectilinears whose covered region changed since the last call are re-checked
     Rectilinear *checkFloorplanLegal(rectilinearIllegalType &illegalType) const;
 
     bool debugFloorplanLegal() const;
@@ -0,0 +1,263 @@
+#include <algorithm>
+#include <unordered_map>
+
+#include "frozenPlane.h"
+#include "floorplan.h"
+#include "cSException.h"
+
+FrozenPlane::FrozenPlane(const CornerStitching &cs)
+    : mCanvasWidth(cs.getCanvasWidth()), mCanvasHeight(cs.getCanvasHeight()), mLeafCount(1) {
+
+    mSourceTiles = cs.getNonBlankTiles();
+    mSourceTiles.insert(mSourceTiles.end(), cs.getBlankTiles().begin(), cs.getBlankTiles().end());
+    // an empty plane is a single canvas-sized BLANK tile, which is not registered
+    if(mSourceTiles.empty()) mSourceTiles.push_back(cs.findPoint(Cord(0, 0)));
+
+    // number the tiles in (yLow, xLow) order
+    std::sort(mSourceTiles.begin(), mSourceTiles.end(), [](Tile *a, Tile *b){
+        if(a->getYLow() != b->getYLow()) return a->getYLow() < b->getYLow();
+        return a->getXLow() < b->getXLow();
+    });
+
+    int tileCount = mSourceTiles.size();
+    mTileRectangles.reserve(tileCount);
+    mTileTypes.reserve(tileCount);
+    for(Tile *const &tile : mSourceTiles){
+        mTileRectangles.push_back(tile->getRectangle());
+        mTileTypes.push_back(tile->getType());
+    }
+
+    // every yLow starts a row, tiles are sorted so the yLows already come in order. Every yHigh is the yLow of another tile or
+    // the canvas height, so each tile covers whole rows
+    mTileFirstRow.resize(tileCount);
+    for(int t = 0; t < tileCount; ++t){
+        len_t yLow = rec::getYL(mTileRectangles[t]);
+        if(mRowY.empty() || (mRowY.back() != yLow)) mRowY.push_back(yLow);
+        mTileFirstRow[t] = mRowY.size() - 1;
+    }
+    mRowY.push_back(mCanvasHeight);
+    int rowCount = mRowY.size() - 1;
+
+    mTileEndRow.resize(tileCount);
+    for(int t = 0; t < tileCount; ++t){
+        mTileEndRow[t] = int(std::lower_bound(mRowY.begin(), mRowY.end(), rec::getYH(mTileRectangles[t])) - mRowY.begin());
+    }
+
+    while(mLeafCount < rowCount) mLeafCount *= 2;
+
+    // the rows of a tile split into at most 2 * log(rows) tree nodes that each cover a whole subtree of rows
+    auto visitTileNodes = [this](int t, auto &&visit){
+        for(int l = mTileFirstRow[t] + mLeafCount, r = mTileEndRow[t] + mLeafCount; l < r; l >>= 1, r >>= 1){
+            if(l & 1) visit(l++);
+            if(r & 1) visit(--r);
+        }
+    };
+
+    mNodeBegin.assign(2 * mLeafCount + 1, 0);
+    for(int t = 0; t < tileCount; ++t){
+        visitTileNodes(t, [this](int node){ ++mNodeBegin[node + 1]; });
+    }
+    for(int n = 0; n < 2 * mLeafCount; ++n){
+        mNodeBegin[n + 1] += mNodeBegin[n];
+    }
+
+    // fill the nodes in xLow order, so every node comes out sorted
+    std::vector<int> xOrder(tileCount);
+    for(int t = 0; t < tileCount; ++t) xOrder[t] = t;
+    std::sort(xOrder.begin(), xOrder.end(), [this](int a, int b){
+        return rec::getXL(mTileRectangles[a]) < rec::getXL(mTileRectangles[b]);
+    });
+
+    std::vector<int> nodeFill(mNodeBegin.begin(), mNodeBegin.end() - 1);
+    mNodeTiles.resize(mNodeBegin.back());
+    mNodeXLow.resize(mNodeBegin.back());
+    for(int const &t : xOrder){
+        visitTileNodes(t, [&](int node){
+            mNodeTiles[nodeFill[node]] = t;
+            mNodeXLow[nodeFill[node]] = rec::getXL(mTileRectangles[t]);
+            ++nodeFill[node];
+        });
+    }
+}
+
+FrozenPlane::FrozenPlane(const Floorplan &fp)
+    : FrozenPlane(*fp.cs) {
+
+    mRectilinears = fp.allRectilinears;
+    std::unordered_map<const Rectilinear *, int> rectIndices;
+    for(int r = 0; r < int(mRectilinears.size()); ++r){
+        rectIndices[mRectilinears[r]] = r;
+    }
+
+    int tileCount = mSourceTiles.size();
+    mPayloadBegin.assign(tileCount + 1, 0);
+    mRectilinearBegin.assign(mRectilinears.size() + 1, 0);
+    for(int t = 0; t < tileCount; ++t){
+        Tile *tile = mSourceTiles[t];
+        if(mTileTypes[t] == tileType::BLOCK){
+            int rectIdx = rectIndices.at(tile->getBlockPayload());
+            mPayloads.push_back(rectIdx);
+            ++mRectilinearBegin[rectIdx + 1];
+        }else if(mTileTypes[t] == tileType::OVERLAP){
+            for(Rectilinear *const &rt : tile->getOverlapPayload()){
+                int rectIdx = rectIndices.at(rt);
+                mPayloads.push_back(rectIdx);
+                ++mRectilinearBegin[rectIdx + 1];
+            }
+        }
+        mPayloadBegin[t + 1] = mPayloads.size();
+    }
+
+    for(int r = 0; r < int(mRectilinears.size()); ++r){
+        mRectilinearBegin[r + 1] += mRectilinearBegin[r];
+    }
+
+    // tiles are visited in index order, so every rectilinear's span comes out sorted
+    std::vector<int> rectFill(mRectilinearBegin.begin(), mRectilinearBegin.end() - 1);
+    mRectilinearTiles.resize(mRectilinearBegin.back());
+    for(int t = 0; t < tileCount; ++t){
+        for(int i = mPayloadBegin[t]; i < mPayloadBegin[t + 1]; ++i){
+            mRectilinearTiles[rectFill[mPayloads[i]]++] = t;
+        }
+    }
+}
+
+int FrozenPlane::findRow(len_t y) const{
+    return int(std::upper_bound(mRowY.begin(), mRowY.end() - 1, y) - mRowY.begin()) - 1;
+}
+
+void FrozenPlane::getNodeRows(int node, int &firstRow, int &endRow) const{
+    int levelBegin = 1;
+    while(2 * levelBegin <= node) levelBegin *= 2;
+    int rowsPerNode = mLeafCount / levelBegin;
+    firstRow = (node - levelBegin) * rowsPerNode;
+    endRow = firstRow + rowsPerNode;
+}
+
+int FrozenPlane::findInNode(int node, len_t x) const{
+    return int(std::upper_bound(mNodeXLow.begin() + mNodeBegin[node], mNodeXLow.begin() + mNodeBegin[node + 1], x) - mNodeXLow.begin()) - 1;
+}
+
+int FrozenPlane::findInRow(int row, len_t x) const{
+    // the tiles crossing row are spread over the path from its leaf to the root, exactly one of them includes x
+    for(int node = mLeafCount + row; node >= 1; node >>= 1){
+        int i = findInNode(node, x);
+        if((i >= mNodeBegin[node]) && (x < rec::getXH(mTileRectangles[mNodeTiles[i]]))) return mNodeTiles[i];
+    }
+    return -1;
+}
+
+void FrozenPlane::enumerateAreaRProcedure(int node, int firstRow, int endRow, len_t xLow, len_t xHigh, std::vector<int> &tiles) const{
+    int nodeFirstRow, nodeEndRow;
+    getNodeRows(node, nodeFirstRow, nodeEndRow);
+    if((nodeFirstRow >= endRow) || (nodeEndRow <= firstRow)) return;
+
+    for(int i = std::max(findInNode(node, xLow), mNodeBegin[node]); (i < mNodeBegin[node + 1]) && (mNodeXLow[i] < xHigh); ++i){
+        int t = mNodeTiles[i];
+        if((mTileTypes[t] == tileType::BLANK) || (rec::getXH(mTileRectangles[t]) <= xLow)) continue;
+        // the nodes of a tile split its rows, only the one holding its first row inside the range pushes it
+        int pushRow = std::max(mTileFirstRow[t], firstRow);
+        if((pushRow >= nodeFirstRow) && (pushRow < nodeEndRow)) tiles.push_back(t);
+    }
+
+    if(node < mLeafCount){
+        enumerateAreaRProcedure(2 * node, firstRow, endRow, xLow, xHigh, tiles);
+        enumerateAreaRProcedure(2 * node + 1, firstRow, endRow, xLow, xHigh, tiles);
+    }
+}
+
+len_t FrozenPlane::getCanvasWidth() const{
+    return this->mCanvasWidth;
+}
+
+len_t FrozenPlane::getCanvasHeight() const{
+    return this->mCanvasHeight;
+}
+
+int FrozenPlane::getTileCount() const{
+    return mTileRectangles.size();
+}
+
+Rectangle FrozenPlane::getTileRectangle(int tileIdx) const{
+    return mTileRectangles[tileIdx];
+}
+
+tileType FrozenPlane::getTileType(int tileIdx) const{
+    return mTileTypes[tileIdx];
+}
+
+Tile *FrozenPlane::getSourceTile(int tileIdx) const{
+    return mSourceTiles[tileIdx];
+}
+
+int FrozenPlane::findPoint(const Cord &key) const{
+    if((key.x() < 0) || (key.x() >= mCanvasWidth) || (key.y() < 0) || (key.y() >= mCanvasHeight)){
+        throw CSException("FROZENPLANE_01");
+    }
+
+    return findInRow(findRow(key.y()), key.x());
+}
+
+void FrozenPlane::enumerateArea(const Rectangle &box, std::vector<int> &tiles) const{
+    len_t xLow = std::max(rec::getXL(box), len_t(0));
+    len_t xHigh = std::min(rec::getXH(box), mCanvasWidth);
+    len_t yLow = std::max(rec::getYL(box), len_t(0));
+    len_t yHigh = std::min(rec::getYH(box), mCanvasHeight);
+    if((xLow >= xHigh) || (yLow >= yHigh)) return;
+
+    enumerateAreaRProcedure(1, findRow(yLow), findRow(yHigh - 1) + 1, xLow, xHigh, tiles);
+}
+
+void FrozenPlane::findNeighbors(int tileIdx, direction2D side, std::vector<int> &neighbors) const{
+    const Rectangle &tileRect = mTileRectangles[tileIdx];
+    switch (side){
+    case direction2D::UP:
+    case direction2D::DOWN:{
+        // the neighbors cross the row right above (below) the tile
+        int row = (side == direction2D::UP)? mTileEndRow[tileIdx] : mTileFirstRow[tileIdx] - 1;
+        if((row < 0) || (row >= int(mRowY.size()) - 1)) return;
+        size_t firstNeighbor = neighbors.size();
+        for(int node = mLeafCount + row; node >= 1; node >>= 1){
+            for(int i = std::max(findInNode(node, rec::getXL(tileRect)), mNodeBegin[node]); (i < mNodeBegin[node + 1]) && (mNodeXLow[i] < rec::getXH(tileRect)); ++i){
+                if(rec::getXH(mTileRectangles[mNodeTiles[i]]) > rec::getXL(tileRect)) neighbors.push_back(mNodeTiles[i]);
+            }
+        }
+        std::sort(neighbors.begin() + firstNeighbor, neighbors.end(), [this](int a, int b){
+            return rec::getXL(mTileRectangles[a]) < rec::getXL(mTileRectangles[b]);
+        });
+        break;
+    }
+    case direction2D::LEFT:
+    case direction2D::RIGHT:{
+        // walk up the column right beside the tile, skipping the rows of each neighbor found
+        len_t x = (side == direction2D::LEFT)? rec::getXL(tileRect) - 1 : rec::getXH(tileRect);
+        if((x < 0) || (x >= mCanvasWidth)) return;
+        for(int row = mTileFirstRow[tileIdx]; row < mTileEndRow[tileIdx]; ){
+            int neighbor = findInRow(row, x);
+            neighbors.push_back(neighbor);
+            row = mTileEndRow[neighbor];
+        }
+        break;
+    }
+    default:
+        throw CSException("FROZENPLANE_02");
+        break;
+    }
+}
+
+int FrozenPlane::getRectilinearCount() const{
+    return mRectilinears.size();
+}
+
+Rectilinear *FrozenPlane::getRectilinear(int rectIdx) const{
+    return mRectilinears[rectIdx];
+}
+
+std::pair<const int *, const int *> FrozenPlane::getTilePayload(int tileIdx) const{
+    if(mPayloadBegin.empty()) return std::pair<const int *, const int *>(nullptr, nullptr);
+    return std::pair<const int *, const int *>(mPayloads.data() + mPayloadBegin[tileIdx], mPayloads.data() + mPayloadBegin[tileIdx + 1]);
+}
+
+std::pair<const int *, const int *> FrozenPlane::getRectilinearTiles(int rectIdx) const{
+    return std::pair<const int *, const int *>(mRectilinearTiles.data() + mRectilinearBegin[rectIdx], mRectilinearTiles.data() + mRectilinearBegin[rectIdx + 1]);
+}
@@ -0,0 +1,95 @@
+#ifndef __FROZENPLANE_H__
+#define __FROZENPLANE_H__
+
+#include <vector>
+#include <utility>
+
+#include "units.h"
+#include "cord.h"
+#include "rectangle.h"
+#include "tile.h"
+#include "rectilinear.h"
+#include "cornerStitching.h"
+
+class Floorplan;
+
+// Immutable copy of a CornerStitching plane (and optionally the payloads of a Floorplan) for phases that only read the plane.
+// Tiles are referred to by index, indices follow the (yLow, xLow) order of the tiles. The canvas is cut into rows at every tile's yLow,
+// and a segment tree is laid over the rows: each tree node keeps, sorted by xLow, the tiles that cross all of its rows but not all rows
+// of its parent. Tiles of one node never share an x, so every query is a few binary searches instead of a stitch walk, and a tile is
+// stored in at most 2 * log(rows) nodes (tall tiles are not repeated in every row they cross).
+// Nothing is modified after construction: any number of threads may query the same FrozenPlane. Edits on the source plane are not
+// reflected, freeze again after editing
+class FrozenPlane{
+private:
+    len_t mCanvasWidth;
+    len_t mCanvasHeight;
+
+    std::vector<Rectangle> mTileRectangles;
+    std::vector<tileType> mTileTypes;
+    std::vector<Tile *> mSourceTiles;
+
+    // row r is the slab mRowY[r] <= y < mRowY[r + 1], tile t covers the rows mTileFirstRow[t] ~ mTileEndRow[t] - 1
+    std::vector<len_t> mRowY;
+    std::vector<int> mTileFirstRow;
+    std::vector<int> mTileEndRow;
+
+    // the segment tree has mLeafCount (a power of two, >= row count) leaves, node 1 is the root and the leaf of row r is mLeafCount + r.
+    // The tiles of node n are mNodeTiles[mNodeBegin[n] ~ mNodeBegin[n + 1] - 1] sorted by xLow, mNodeXLow[i] is the xLow of mNodeTiles[i]
+    int mLeafCount;
+    std::vector<int> mNodeBegin;
+    std::vector<int> mNodeTiles;
+    std::vector<len_t> mNodeXLow;
+
+    // filled only when frozen from a Floorplan. The payload of tile t is mPayloads[mPayloadBegin[t] ~ mPayloadBegin[t + 1] - 1],
+    // the tiles of rectilinear r are mRectilinearTiles[mRectilinearBegin[r] ~ mRectilinearBegin[r + 1] - 1], in index order.
+    // Rectilinear indices follow Floorplan::allRectilinears
+    std::vector<Rectilinear *> mRectilinears;
+    std::vector<int> mPayloadBegin;
+    std::vector<int> mPayloads;
+    std::vector<int> mRectilinearBegin;
+    std::vector<int> mRectilinearTiles;
+
+    // the row that includes y
+    int findRow(len_t y) const;
+    // the first and one-past-last row covered by tree node
+    void getNodeRows(int node, int &firstRow, int &endRow) const;
+    // position (in mNodeTiles) of the last tile of node whose xLow <= x, mNodeBegin[node] - 1 if there is none
+    int findInNode(int node, len_t x) const;
+    // index of the tile that crosses row and includes x
+    int findInRow(int row, len_t x) const;
+
+    // Helper function of enumerateArea, pushes the nonblank tiles of node and its subtree that overlap the rows firstRow ~ endRow - 1
+    // and xLow <= x < xHigh, each tile is pushed by the node holding the first of its rows inside the range
+    void enumerateAreaRProcedure(int node, int firstRow, int endRow, len_t xLow, len_t xHigh, std::vector<int> &tiles) const;
+
+public:
+    explicit FrozenPlane(const CornerStitching &cs);
+    explicit FrozenPlane(const Floorplan &fp);
+
+    len_t getCanvasWidth() const;
+    len_t getCanvasHeight() const;
+
+    int getTileCount() const;
+    Rectangle getTileRectangle(int tileIdx) const;
+    tileType getTileType(int tileIdx) const;
+    // the tile of the plane the FrozenPlane was built from, only valid while that tile is alive
+    Tile *getSourceTile(int tileIdx) const;
+
+    // index of the tile (BLANK included) that includes key, same convention as CornerStitching::findPoint
+    int findPoint(const Cord &key) const;
+    // push the indices of every nonblank tile overlapping box (with positive area) into tiles, each tile is pushed once
+    void enumerateArea(const Rectangle &box, std::vector<int> &tiles) const;
+    // push the indices of all neighbors on side (UP, LEFT, DOWN or RIGHT) of tile tileIdx into neighbors,
+    // UP/DOWN neighbors are ordered from left to right, LEFT/RIGHT neighbors from bottom to top
+    void findNeighbors(int tileIdx, direction2D side, std::vector<int> &neighbors) const;
+
+    int getRectilinearCount() const;
+    Rectilinear *getRectilinear(int rectIdx) const;
+    // [first, second) span of the rectilinear indices that tile tileIdx belongs to (empty for BLANK tiles)
+    std::pair<const int *, const int *> getTilePayload(int tileIdx) const;
+    // [first, second) span of the tile indices of rectilinear rectIdx (both block & overlap tiles)
+    std::pair<const int *, const int *> getRectilinearTiles(int rectIdx) const;
+};
+
+#endif // __FROZENPLANE_H__
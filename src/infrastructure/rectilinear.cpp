@@ -1,4 +1,5 @@
 #include <climits>
+#include <algorithm>
 
 #include "rectilinear.h"
 #include "cSException.h"
@@ -7,20 +8,24 @@
 
 Rectilinear::Rectilinear()
     : mId(-1), mName(""), mType(rectilinearType::EMPTY), mGlobalPlacement(Rectangle(0, 0, 0, 0)),
-    mLegalArea(0), mAspectRatioMin(0), mAspectRatioMax(std::numeric_limits<double>::max()), mUtilizationMin(0){
+    mLegalArea(0), mAspectRatioMin(0), mAspectRatioMax(std::numeric_limits<double>::max()), mUtilizationMin(0),
+    mActualArea(0), mBoundingBox(Rectangle(0, 0, 0, 0)), mBoundingBoxEdgeCounts{0, 0, 0, 0}, mBoundingBoxStale(true){
 }
 
 Rectilinear::Rectilinear(int id, std::string name, rectilinearType type, Rectangle initPlacement,
                         area_t legalArea, double aspectRatioMin, double aspectRatioMax, double utilizationMin)
     : mId(id), mName(name), mType(type), mGlobalPlacement(initPlacement),
-    mLegalArea(legalArea), mAspectRatioMin(aspectRatioMin), mAspectRatioMax(aspectRatioMax), mUtilizationMin(utilizationMin){
+    mLegalArea(legalArea), mAspectRatioMin(aspectRatioMin), mAspectRatioMax(aspectRatioMax), mUtilizationMin(utilizationMin),
+    mActualArea(0), mBoundingBox(Rectangle(0, 0, 0, 0)), mBoundingBoxEdgeCounts{0, 0, 0, 0}, mBoundingBoxStale(true){
 }
 
 Rectilinear::Rectilinear(const Rectilinear &other)
     : mId(other.mId), mName(other.mName), mType(other.mType), mGlobalPlacement(other.mGlobalPlacement),
-    mLegalArea(other.mLegalArea), mAspectRatioMin(other.mAspectRatioMin), mAspectRatioMax(other.mAspectRatioMax), mUtilizationMin(other.mUtilizationMin){
-        this->blockTiles = std::unordered_set<Tile *>(other.blockTiles.begin(), other.blockTiles.end());
-        this->overlapTiles = std::unordered_set<Tile *>(other.overlapTiles.begin(), other.overlapTiles.end());
+    mLegalArea(other.mLegalArea), mAspectRatioMin(other.mAspectRatioMin), mAspectRatioMax(other.mAspectRatioMax), mUtilizationMin(other.mUtilizationMin),
+    mActualArea(other.mActualArea), mBoundingBox(other.mBoundingBox), mBoundingBoxStale(other.mBoundingBoxStale){
+        std::copy(other.mBoundingBoxEdgeCounts, other.mBoundingBoxEdgeCounts + 4, this->mBoundingBoxEdgeCounts);
+        this->blockTiles = other.blockTiles;
+        this->overlapTiles = other.overlapTiles;
 }
 
 Rectilinear &Rectilinear::operator = (const Rectilinear &other) {
@@ -35,8 +40,13 @@ Rectilinear &Rectilinear::operator = (const Rectilinear &other) {
     this->mAspectRatioMax = other.mAspectRatioMax;
     this->mUtilizationMin = other.mUtilizationMin;
 
-    this->blockTiles = std::unordered_set<Tile *>(other.blockTiles);
-    this->overlapTiles = std::unordered_set<Tile*>(other.overlapTiles);
+    this->mActualArea = other.mActualArea;
+    this->mBoundingBox = other.mBoundingBox;
+    std::copy(other.mBoundingBoxEdgeCounts, other.mBoundingBoxEdgeCounts + 4, this->mBoundingBoxEdgeCounts);
+    this->mBoundingBoxStale = other.mBoundingBoxStale;
+
+    this->blockTiles = other.blockTiles;
+    this->overlapTiles = other.overlapTiles;
 
     return (*this);
 }
@@ -104,6 +114,66 @@ void Rectilinear::setUtilizationMin(double utilizationMin){
     this->mUtilizationMin = utilizationMin;
 }
 
+void Rectilinear::recomputeBoundingBox() const {
+    Tile *randomTile = (blockTiles.empty())? (*(overlapTiles.begin())) : (*(blockTiles.begin()));
+    len_t BBXL = randomTile->getXLow();
+    len_t BBYL = randomTile->getYLow();
+    len_t BBXH = randomTile->getXHigh();
+    len_t BBYH = randomTile->getYHigh();
+    int edgeCounts[4] = {0, 0, 0, 0};
+
+    for(const TileList *tiles : {&blockTiles, &overlapTiles}){
+        for(Tile *const &t : *tiles){
+            len_t xl = t->getXLow();
+            len_t yl = t->getYLow();
+            len_t xh = t->getXHigh();
+            len_t yh = t->getYHigh();
+
+            if(xl < BBXL){ BBXL = xl; edgeCounts[0] = 1; }else if(xl == BBXL) ++edgeCounts[0];
+            if(yl < BBYL){ BBYL = yl; edgeCounts[1] = 1; }else if(yl == BBYL) ++edgeCounts[1];
+            if(xh > BBXH){ BBXH = xh; edgeCounts[2] = 1; }else if(xh == BBXH) ++edgeCounts[2];
+            if(yh > BBYH){ BBYH = yh; edgeCounts[3] = 1; }else if(yh == BBYH) ++edgeCounts[3];
+        }
+    }
+
+    this->mBoundingBox = Rectangle(BBXL, BBYL, BBXH, BBYH);
+    std::copy(edgeCounts, edgeCounts + 4, this->mBoundingBoxEdgeCounts);
+    this->mBoundingBoxStale = false;
+}
+
+void Rectilinear::growShape(const Rectangle &tileRectangle){
+    this->mActualArea += rec::getArea(tileRectangle);
+    if(this->mBoundingBoxStale) return;
+
+    len_t xl = rec::getXL(tileRectangle);
+    len_t yl = rec::getYL(tileRectangle);
+    len_t xh = rec::getXH(tileRectangle);
+    len_t yh = rec::getYH(tileRectangle);
+    len_t BBXL = rec::getXL(mBoundingBox);
+    len_t BBYL = rec::getYL(mBoundingBox);
+    len_t BBXH = rec::getXH(mBoundingBox);
+    len_t BBYH = rec::getYH(mBoundingBox);
+
+    if(xl < BBXL){ BBXL = xl; mBoundingBoxEdgeCounts[0] = 1; }else if(xl == BBXL) ++mBoundingBoxEdgeCounts[0];
+    if(yl < BBYL){ BBYL = yl; mBoundingBoxEdgeCounts[1] = 1; }else if(yl == BBYL) ++mBoundingBoxEdgeCounts[1];
+    if(xh > BBXH){ BBXH = xh; mBoundingBoxEdgeCounts[2] = 1; }else if(xh == BBXH) ++mBoundingBoxEdgeCounts[2];
+    if(yh > BBYH){ BBYH = yh; mBoundingBoxEdgeCounts[3] = 1; }else if(yh == BBYH) ++mBoundingBoxEdgeCounts[3];
+
+    this->mBoundingBox = Rectangle(BBXL, BBYL, BBXH, BBYH);
+}
+
+void Rectilinear::shrinkShape(const Rectangle &tileRectangle){
+    this->mActualArea -= rec::getArea(tileRectangle);
+    if(this->mBoundingBoxStale) return;
+
+    // splitting a tile never lowers the number of tiles on an edge, so the counts only err on the low side and
+    // an edge count dropping to 0 is the earliest the box may have shrunk
+    if((rec::getXL(tileRectangle) == rec::getXL(mBoundingBox)) && (--mBoundingBoxEdgeCounts[0] == 0)) mBoundingBoxStale = true;
+    if((rec::getYL(tileRectangle) == rec::getYL(mBoundingBox)) && (--mBoundingBoxEdgeCounts[1] == 0)) mBoundingBoxStale = true;
+    if((rec::getXH(tileRectangle) == rec::getXH(mBoundingBox)) && (--mBoundingBoxEdgeCounts[2] == 0)) mBoundingBoxStale = true;
+    if((rec::getYH(tileRectangle) == rec::getYH(mBoundingBox)) && (--mBoundingBoxEdgeCounts[3] == 0)) mBoundingBoxStale = true;
+}
+
 Rectangle Rectilinear::calculateBoundingBox() const {
     if(this->mType == rectilinearType::PIN) return this->mGlobalPlacement;
     
@@ -114,62 +184,16 @@ Rectangle Rectilinear::calculateBoundingBox() const {
         return mGlobalPlacement;
     }
 
-    len_t BBXL, BBYL, BBXH, BBYH;
-    Tile *randomTile = (blockTiles.empty())? (*(overlapTiles.begin())) : (*(blockTiles.begin()));
-
-    BBXL = (randomTile)->getXLow();
-    BBYL = (randomTile)->getYLow();
-    BBXH = (randomTile)->getXHigh();
-    BBYH = (randomTile)->getYHigh();
-
-    for(Tile *const &t : blockTiles){
-        len_t xl = t->getXLow();
-        len_t yl = t->getYLow();
-        len_t xh = t->getXHigh();
-        len_t yh = t->getYHigh();
-        
-        if(xl < BBXL) BBXL = xl;
-        if(yl < BBYL) BBYL = yl;
-        if(xh > BBXH) BBXH = xh;
-        if(yh > BBYH) BBYH = yh;
-    }
-    for(Tile *const &t : overlapTiles){
-        len_t xl = t->getXLow();
-        len_t yl = t->getYLow();
-        len_t xh = t->getXHigh();
-        len_t yh = t->getYHigh();
-        
-        if(xl < BBXL) BBXL = xl;
-        if(yl < BBYL) BBYL = yl;
-        if(xh > BBXH) BBXH = xh;
-        if(yh > BBYH) BBYH = yh;
-    }
-
-    return Rectangle(BBXL, BBYL, BBXH, BBYH);
+    if(this->mBoundingBoxStale) recomputeBoundingBox();
+    return this->mBoundingBox;
 }
 
 area_t Rectilinear::calculateActualArea() const {
-    area_t actualArea = 0;
-    for(Tile *const &t : blockTiles){
-        actualArea += t->getArea();
-    }
-    for(Tile *const &t : overlapTiles){
-        actualArea += t->getArea();
-    }
-    return actualArea;
+    return this->mActualArea;
 }
 
 area_t Rectilinear::calculateResidualArea() const {
-
-    area_t actualArea = 0;
-    for(Tile *const &t : blockTiles){
-        actualArea += t->getArea();
-    }
-    for(Tile *const &t : overlapTiles){
-        actualArea += t->getArea();
-    }
-    
-    return actualArea - mLegalArea;
+    return this->mActualArea - mLegalArea;
 }
 
 double Rectilinear::calculateUtilization() const {
@@ -2,10 +2,10 @@
 #define __RECTILINEAR_H__
 
 #include <string.h>
-#include <unordered_set>
 
 #include "rectangle.h"
 #include "tile.h"
+#include "tileList.h"
 
 enum class rectilinearType{
     EMPTY, SOFT, PREPLACED, PIN
@@ -29,10 +29,21 @@ private:
 
     double mUtilizationMin;
 
+    // Area and bounding box of the region covered by the tiles, maintained through growShape()/shrinkShape(). mBoundingBoxEdgeCounts
+    // counts the tiles lying on each edge of mBoundingBox (left, bottom, right, top), the box is recomputed from the tiles only after
+    // an edge loses its last tile
+    area_t mActualArea;
+    mutable Rectangle mBoundingBox;
+    mutable int mBoundingBoxEdgeCounts[4];
+    mutable bool mBoundingBoxStale;
+
+    // recompute mBoundingBox & mBoundingBoxEdgeCounts by visiting every tile
+    void recomputeBoundingBox() const;
+
 public: 
 
-    std::unordered_set<Tile *> blockTiles;
-    std::unordered_set<Tile *> overlapTiles;
+    TileList blockTiles;
+    TileList overlapTiles;
 
     Rectilinear();
     Rectilinear(int id, std::string name, rectilinearType type, Rectangle globalPlacement,
@@ -61,9 +72,16 @@ public:
     void setAspectRatioMin(double aspectRatioMin);
     void setAspectRatioMax(double aspectRatioMax);
     void setUtilizationMin(double utilizationMin);
+
+    // the tiles of the rectilinear start (growShape) or stop (shrinkShape) covering tileRectangle, keeps the area and bounding box
+    // up to date. Call whenever blockTiles/overlapTiles gain or lose covered region, re-dicing the same region needs no call
+    void growShape(const Rectangle &tileRectangle);
+    void shrinkShape(const Rectangle &tileRectangle);
     
 
+    // O(1) unless the bounding box shrank since the last call
     Rectangle calculateBoundingBox() const;
+    // O(1), maintained by growShape()/shrinkShape()
     area_t calculateActualArea() const;
     area_t calculateResidualArea() const;
     double calculateUtilization() const;
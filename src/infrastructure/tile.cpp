@@ -1,27 +1,118 @@
 #include <iostream>
+#include <algorithm>
 
 #include "tile.h"
 #include "cSException.h"
 
+OverlapPayload::OverlapPayload()
+    : mSize(0), mCapacity(INLINE_CAPACITY) {
+}
+
+OverlapPayload::OverlapPayload(std::initializer_list<Rectilinear *> rectilinears)
+    : OverlapPayload() {
+    assign(rectilinears.begin(), rectilinears.end());
+}
+
+OverlapPayload::OverlapPayload(const std::vector<Rectilinear *> &rectilinears)
+    : OverlapPayload() {
+    assign(rectilinears.data(), rectilinears.data() + rectilinears.size());
+}
+
+OverlapPayload::OverlapPayload(const OverlapPayload &other)
+    : OverlapPayload() {
+    assign(other.begin(), other.end());
+}
+
+OverlapPayload::~OverlapPayload() {
+    if(mCapacity > INLINE_CAPACITY) delete[] mHeap;
+}
+
+OverlapPayload &OverlapPayload::operator = (const OverlapPayload &other) {
+    if(this != &other) assign(other.begin(), other.end());
+    return (*this);
+}
+
+void OverlapPayload::reserve(size_t capacity) {
+    Rectilinear **heap = new Rectilinear *[capacity];
+    std::copy(begin(), end(), heap);
+    if(mCapacity > INLINE_CAPACITY) delete[] mHeap;
+    mHeap = heap;
+    mCapacity = capacity;
+}
+
+void OverlapPayload::assign(Rectilinear *const *first, Rectilinear *const *last) {
+    size_t count = last - first;
+    if(count > mCapacity) reserve(count);
+    std::copy(first, last, begin());
+    mSize = count;
+}
+
+size_t OverlapPayload::size() const {
+    return this->mSize;
+}
+
+bool OverlapPayload::empty() const {
+    return (this->mSize == 0);
+}
+
+Rectilinear *OverlapPayload::operator [] (size_t idx) const {
+    return begin()[idx];
+}
+
+OverlapPayload::iterator OverlapPayload::begin() {
+    return (mCapacity > INLINE_CAPACITY)? mHeap : mInline;
+}
+
+OverlapPayload::iterator OverlapPayload::end() {
+    return begin() + mSize;
+}
+
+OverlapPayload::const_iterator OverlapPayload::begin() const {
+    return (mCapacity > INLINE_CAPACITY)? mHeap : mInline;
+}
+
+OverlapPayload::const_iterator OverlapPayload::end() const {
+    return begin() + mSize;
+}
+
+void OverlapPayload::push_back(Rectilinear *rectilinear) {
+    if(mSize == mCapacity) reserve(2 * mCapacity);
+    begin()[mSize++] = rectilinear;
+}
+
+void OverlapPayload::erase(iterator pos) {
+    if(pos == end()) return;
+    std::copy(pos + 1, end(), pos);
+    --mSize;
+}
+
+void OverlapPayload::clear() {
+    mSize = 0;
+}
+
+std::vector<Rectilinear *> OverlapPayload::toVector() const {
+    return std::vector<Rectilinear *>(begin(), end());
+}
 
 Tile::Tile()
-    : mType(tileType::BLANK), mRectangle(Rectangle(0, 0, 0, 0)), rt(nullptr), tr(nullptr), bl(nullptr), lb(nullptr) {
+    : mType(tileType::BLANK), mRectangle(Rectangle(0, 0, 0, 0)), mRegistryIndex(-1), mTileListIndex(-1), mBlockPayload(nullptr), rt(nullptr), tr(nullptr), bl(nullptr), lb(nullptr) {
 }
 
 Tile::Tile(tileType t, Rectangle rect)
-    : mType(t), mRectangle(rect), rt(nullptr), tr(nullptr), bl(nullptr), lb(nullptr) {
+    : mType(t), mRectangle(rect), mRegistryIndex(-1), mTileListIndex(-1), mBlockPayload(nullptr), rt(nullptr), tr(nullptr), bl(nullptr), lb(nullptr) {
 }
 
 Tile::Tile(tileType t, Cord ll, len_t w, len_t h)
-    : mType(t), mRectangle(Rectangle(ll.x(), ll.y(), (len_t)(ll.x() + w), (len_t)(ll.y() + h))), rt(nullptr), tr(nullptr), bl(nullptr), lb(nullptr) {
+    : mType(t), mRectangle(Rectangle(ll.x(), ll.y(), (len_t)(ll.x() + w), (len_t)(ll.y() + h))), mRegistryIndex(-1), mTileListIndex(-1), mBlockPayload(nullptr), rt(nullptr), tr(nullptr), bl(nullptr), lb(nullptr) {
 }
 
 Tile::Tile(tileType t, Cord ll, Cord ur)
-    : mType(t), mRectangle(Rectangle(ll.x(), ll.y(), ur.x(), ur.y())), rt(nullptr), tr(nullptr), bl(nullptr), lb(nullptr) {
+    : mType(t), mRectangle(Rectangle(ll.x(), ll.y(), ur.x(), ur.y())), mRegistryIndex(-1), mTileListIndex(-1), mBlockPayload(nullptr), rt(nullptr), tr(nullptr), bl(nullptr), lb(nullptr) {
 }
 
 Tile::Tile(const Tile &other)
-    : mType(other.getType()), mRectangle(other.getRectangle()), rt(other.rt), tr(other.tr), bl(other.bl), lb(other.lb) {
+    : mType(other.getType()), mRectangle(other.getRectangle()), mRegistryIndex(other.mRegistryIndex), mTileListIndex(other.mTileListIndex),
+    mBlockPayload(other.mBlockPayload), mOverlapPayload(other.mOverlapPayload), rt(other.rt), tr(other.tr), bl(other.bl), lb(other.lb) {
 }
 
 Tile &Tile::operator = (const Tile &other) {
@@ -29,6 +120,10 @@ Tile &Tile::operator = (const Tile &other) {
 
     this->mType = other.getType();
     this->mRectangle = other.getRectangle();
+    this->mRegistryIndex = other.mRegistryIndex;
+    this->mTileListIndex = other.mTileListIndex;
+    this->mBlockPayload = other.mBlockPayload;
+    this->mOverlapPayload = other.mOverlapPayload;
 
     this->rt = other.rt;
     this->tr = other.tr;
@@ -49,6 +144,12 @@ tileType Tile::getType() const {
 Rectangle Tile::getRectangle() const {
     return this->mRectangle;
 }
+Rectilinear *Tile::getBlockPayload() const {
+    return this->mBlockPayload;
+}
+const OverlapPayload &Tile::getOverlapPayload() const {
+    return this->mOverlapPayload;
+}
 
 len_t Tile::getWidth() const {
     return rec::getWidth(this->mRectangle);
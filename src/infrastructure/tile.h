@@ -1,6 +1,9 @@
 #ifndef __TILE_H__
 #define __TILE_H__
 
+#include <vector>
+#include <initializer_list>
+
 #include "boost/polygon/polygon.hpp"
 #include "units.h"
 #include "cord.h"
@@ -8,14 +11,75 @@
 
 namespace gtl = boost::polygon;
 
+class Rectilinear;
+
 enum class tileType{
     BLANK, BLOCK, OVERLAP
 };
 
+// The rectilinears overlapping on an OVERLAP tile. Up to INLINE_CAPACITY of them are kept inside the object, so the usual two or
+// three-way overlap allocates nothing; a longer list spills into a heap array
+class OverlapPayload{
+private:
+    static const size_t INLINE_CAPACITY = 3;
+
+    size_t mSize;
+    // INLINE_CAPACITY while the rectilinears are kept in mInline, else the size of the mHeap array
+    size_t mCapacity;
+    union{
+        Rectilinear *mInline[INLINE_CAPACITY];
+        Rectilinear **mHeap;
+    };
+
+    // move the rectilinears into a heap array of capacity (> mCapacity) slots
+    void reserve(size_t capacity);
+    void assign(Rectilinear *const *first, Rectilinear *const *last);
+
+public:
+    typedef Rectilinear **iterator;
+    typedef Rectilinear *const *const_iterator;
+
+    OverlapPayload();
+    OverlapPayload(std::initializer_list<Rectilinear *> rectilinears);
+    OverlapPayload(const std::vector<Rectilinear *> &rectilinears);
+    OverlapPayload(const OverlapPayload &other);
+    ~OverlapPayload();
+
+    OverlapPayload &operator = (const OverlapPayload &other);
+
+    size_t size() const;
+    bool empty() const;
+    Rectilinear *operator [] (size_t idx) const;
+
+    iterator begin();
+    iterator end();
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    void push_back(Rectilinear *rectilinear);
+    // remove the rectilinear at pos (nothing happens if pos is end()), the ones after it keep their order
+    void erase(iterator pos);
+    void clear();
+
+    std::vector<Rectilinear *> toVector() const;
+};
+
 class Tile{
 private:
     tileType mType;
     Rectangle mRectangle;
+    // position of the tile inside CornerStitching::mNonBlankTiles (mBlankTiles for a BLANK tile), only meaningful while it is part of a plane
+    int mRegistryIndex;
+    // position of a BLOCK tile inside the TileList holding it (OVERLAP tiles are indexed by each of their lists), see TileList
+    int mTileListIndex;
+    // payload inside a Floorplan, the rectilinear owning a BLOCK tile or the rectilinears overlapping on an OVERLAP tile.
+    // Only written by Floorplan, CornerStitching carries it along untouched
+    Rectilinear *mBlockPayload;
+    OverlapPayload mOverlapPayload;
+
+    friend class CornerStitching;
+    friend class Floorplan;
+    friend class TileList;
 
 public:
     Tile *rt, *tr, *bl, *lb;
@@ -32,6 +96,9 @@ public:
     
     tileType getType() const;
     Rectangle getRectangle() const;
+    // payload of the tile inside a Floorplan: nullptr / empty unless the tile is a BLOCK / OVERLAP tile of a Floorplan
+    Rectilinear *getBlockPayload() const;
+    const OverlapPayload &getOverlapPayload() const;
 
     len_t getWidth() const;
     len_t getHeight() const;
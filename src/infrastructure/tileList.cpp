@@ -0,0 +1,96 @@
+#include <algorithm>
+
+#include "tileList.h"
+
+int TileList::findPosition(Tile *tile) const{
+    if(!mSharedPositions.empty()){
+        std::unordered_map<Tile *, int>::const_iterator it = mSharedPositions.find(tile);
+        if(it != mSharedPositions.end()) return it->second;
+    }
+
+    int hint = tile->mTileListIndex;
+    if((hint >= 0) && (hint < int(mTiles.size())) && (mTiles[hint] == tile)) return hint;
+
+    // only reached for a BLOCK tile absent from the list, or held by a copy of the list it was inserted into
+    for(int i = int(mTiles.size()) - 1; i >= 0; --i){
+        if(mTiles[i] == tile) return i;
+    }
+    return -1;
+}
+
+void TileList::setPosition(Tile *tile, int position){
+    if(!mSharedPositions.empty()){
+        std::unordered_map<Tile *, int>::iterator it = mSharedPositions.find(tile);
+        if(it != mSharedPositions.end()){
+            it->second = position;
+            return;
+        }
+    }
+    tile->mTileListIndex = position;
+}
+
+TileList::TileList() {
+}
+
+bool TileList::operator == (const TileList &comp) const{
+    return (mTiles.size() == comp.mTiles.size()) && std::is_permutation(mTiles.begin(), mTiles.end(), comp.mTiles.begin());
+}
+
+bool TileList::operator != (const TileList &comp) const{
+    return !(*this == comp);
+}
+
+bool TileList::insert(Tile *tile){
+    int position = mTiles.size();
+    if(tile->getType() == tileType::OVERLAP){
+        if(!mSharedPositions.emplace(tile, position).second) return false;
+    }else{
+        int hint = tile->mTileListIndex;
+        if((hint >= 0) && (hint < position) && (mTiles[hint] == tile)) return false;
+        tile->mTileListIndex = position;
+    }
+    mTiles.push_back(tile);
+    return true;
+}
+
+size_t TileList::erase(Tile *tile){
+    int pos = findPosition(tile);
+    if(pos < 0) return 0;
+
+    Tile *last = mTiles.back();
+    mTiles[pos] = last;
+    setPosition(last, pos);
+    mTiles.pop_back();
+    mSharedPositions.erase(tile);
+    return 1;
+}
+
+void TileList::clear(){
+    mTiles.clear();
+    mSharedPositions.clear();
+}
+
+void TileList::reserve(size_t capacity){
+    mTiles.reserve(capacity);
+}
+
+void TileList::swap(TileList &other){
+    mTiles.swap(other.mTiles);
+    mSharedPositions.swap(other.mSharedPositions);
+}
+
+size_t TileList::size() const{
+    return mTiles.size();
+}
+
+bool TileList::empty() const{
+    return mTiles.empty();
+}
+
+TileList::const_iterator TileList::begin() const{
+    return mTiles.begin();
+}
+
+TileList::const_iterator TileList::end() const{
+    return mTiles.end();
+}
@@ -0,0 +1,45 @@
+#ifndef __TILELIST_H__
+#define __TILELIST_H__
+
+#include <vector>
+#include <unordered_map>
+
+#include "tile.h"
+
+// Dense, unordered list of distinct tiles (e.g. Rectilinear::blockTiles), iterated in insertion order until an erase moves the last
+// tile into the freed slot, so the list must not be modified while it is iterated.
+// A BLOCK tile lives in a single list and remembers its position there (Tile::mTileListIndex). An OVERLAP tile is shared by the lists
+// of its payload, so each list indexes the OVERLAP tiles it holds by itself (mSharedPositions). Both make insert() & erase() O(1)
+class TileList{
+private:
+    std::vector<Tile *> mTiles;
+    // position inside mTiles of every tile inserted as an OVERLAP tile
+    std::unordered_map<Tile *, int> mSharedPositions;
+
+    // position of tile inside mTiles, -1 if absent
+    int findPosition(Tile *tile) const;
+    void setPosition(Tile *tile, int position);
+
+public:
+    typedef std::vector<Tile *>::const_iterator const_iterator;
+
+    TileList();
+
+    bool operator == (const TileList &comp) const;
+    bool operator != (const TileList &comp) const;
+
+    // returns false (and leaves the list untouched) if tile is in the list already
+    bool insert(Tile *tile);
+    // returns the number of tiles erased (0 or 1)
+    size_t erase(Tile *tile);
+    void clear();
+    void reserve(size_t capacity);
+    void swap(TileList &other);
+
+    size_t size() const;
+    bool empty() const;
+    const_iterator begin() const;
+    const_iterator end() const;
+};
+
+#endif // __TILELIST_H__
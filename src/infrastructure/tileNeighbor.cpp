@@ -0,0 +1,106 @@
+#include "tileNeighbor.h"
+#include "cSException.h"
+
+Tile *TileNeighborIterator::firstOfSide() const{
+    switch (mSideIdx){
+    case 0:
+        return mCentre->rt;
+    case 1:
+        return mCentre->bl;
+    case 2:
+        return mCentre->lb;
+    default:
+        return mCentre->tr;
+    }
+}
+
+void TileNeighborIterator::settleOnSide(){
+    while((mCurrent == nullptr) && (mSideIdx < mLastSideIdx)){
+        ++mSideIdx;
+        mCurrent = firstOfSide();
+    }
+}
+
+TileNeighborIterator::TileNeighborIterator()
+    : mCentre(nullptr), mCurrent(nullptr), mSideIdx(0), mLastSideIdx(0) {
+}
+
+TileNeighborIterator::TileNeighborIterator(Tile *centre, int firstSideIdx, int lastSideIdx)
+    : mCentre(centre), mCurrent(nullptr), mSideIdx(firstSideIdx), mLastSideIdx(lastSideIdx) {
+    if(centre == nullptr) return;
+    mCurrent = firstOfSide();
+    settleOnSide();
+}
+
+Tile *TileNeighborIterator::operator * () const{
+    return mCurrent;
+}
+
+TileNeighborIterator &TileNeighborIterator::operator ++ (){
+    // the last neighbor of each side is the first one reaching the far corner of the centre tile
+    switch (mSideIdx){
+    case 0:
+        mCurrent = (mCurrent->getXLow() > mCentre->getXLow())? mCurrent->bl : nullptr;
+        break;
+    case 1:
+        mCurrent = (mCurrent->getYHigh() < mCentre->getYHigh())? mCurrent->rt : nullptr;
+        break;
+    case 2:
+        mCurrent = (mCurrent->getXHigh() < mCentre->getXHigh())? mCurrent->tr : nullptr;
+        break;
+    default:
+        mCurrent = (mCurrent->getYLow() > mCentre->getYLow())? mCurrent->lb : nullptr;
+        break;
+    }
+    settleOnSide();
+    return *this;
+}
+
+TileNeighborIterator TileNeighborIterator::operator ++ (int){
+    TileNeighborIterator before(*this);
+    ++(*this);
+    return before;
+}
+
+bool TileNeighborIterator::operator == (const TileNeighborIterator &comp) const{
+    if((mCurrent == nullptr) || (comp.mCurrent == nullptr)) return (mCurrent == comp.mCurrent);
+    return (mCurrent == comp.mCurrent) && (mCentre == comp.mCentre) && (mSideIdx == comp.mSideIdx);
+}
+
+bool TileNeighborIterator::operator != (const TileNeighborIterator &comp) const{
+    return !(*this == comp);
+}
+
+TileNeighborRange::TileNeighborRange(Tile *centre, direction2D side)
+    : mCentre(centre) {
+    switch (side){
+    case direction2D::UP:
+        mFirstSideIdx = 0;
+        break;
+    case direction2D::LEFT:
+        mFirstSideIdx = 1;
+        break;
+    case direction2D::DOWN:
+        mFirstSideIdx = 2;
+        break;
+    case direction2D::RIGHT:
+        mFirstSideIdx = 3;
+        break;
+    default:
+        throw CSException("TILENEIGHBOR_01");
+        break;
+    }
+    mLastSideIdx = mFirstSideIdx;
+}
+
+TileNeighborRange::TileNeighborRange(Tile *centre)
+    : mCentre(centre), mFirstSideIdx(0), mLastSideIdx(3) {
+}
+
+TileNeighborIterator TileNeighborRange::begin() const{
+    return TileNeighborIterator(mCentre, mFirstSideIdx, mLastSideIdx);
+}
+
+TileNeighborIterator TileNeighborRange::end() const{
+    return TileNeighborIterator();
+}
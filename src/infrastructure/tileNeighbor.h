@@ -0,0 +1,61 @@
+#ifndef __TILENEIGHBOR_H__
+#define __TILENEIGHBOR_H__
+
+#include <iterator>
+
+#include "units.h"
+#include "tile.h"
+
+// Iterator that walks the neighbors of a tile through the corner stitches, one neighbor per increment.
+// Sides are visited in the order UP, LEFT, DOWN, RIGHT (same as CornerStitching::findAllNeighbors), within a side the order is
+// the same as CornerStitching::find{Top, Left, Down, Right}Neighbors. Stitches must not be modified during the iteration
+class TileNeighborIterator{
+private:
+    Tile *mCentre;
+    Tile *mCurrent;
+    int mSideIdx;
+    int mLastSideIdx;
+
+    // the neighbor the walk of the current side starts from, nullptr if the side has no neighbor
+    Tile *firstOfSide() const;
+    // if the current side has no neighbor, move to the first neighbor of the next non-empty side (or the end)
+    void settleOnSide();
+
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Tile *value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Tile **pointer;
+    typedef Tile *reference;
+
+    // the end iterator
+    TileNeighborIterator();
+    // walk the sides firstSideIdx ~ lastSideIdx of centre, the index of a side is its position in the order UP, LEFT, DOWN, RIGHT
+    TileNeighborIterator(Tile *centre, int firstSideIdx, int lastSideIdx);
+
+    Tile *operator * () const;
+    TileNeighborIterator &operator ++ ();
+    TileNeighborIterator operator ++ (int);
+    bool operator == (const TileNeighborIterator &comp) const;
+    bool operator != (const TileNeighborIterator &comp) const;
+};
+
+// Range of neighbors of a tile, used as "for(Tile *neighbor : TileNeighborRange(tile, direction2D::UP))"
+// Nothing is collected beforehand, the neighbors are walked on demand and the loop may exit at any time
+class TileNeighborRange{
+private:
+    Tile *mCentre;
+    int mFirstSideIdx;
+    int mLastSideIdx;
+
+public:
+    // neighbors on a single side, side should be either UP, LEFT, DOWN or RIGHT
+    TileNeighborRange(Tile *centre, direction2D side);
+    // neighbors on all four sides
+    explicit TileNeighborRange(Tile *centre);
+
+    TileNeighborIterator begin() const;
+    TileNeighborIterator end() const;
+};
+
+#endif // __TILENEIGHBOR_H__
@@ -8,7 +8,16 @@
 
 #include "boost/polygon/polygon.hpp"
 
+// Coordinates are 32-bit by default. Builds defining COORDINATE_64BIT (make COORDBITS=64) widen them to 64-bit for canvases
+// beyond the 32-bit range, at the cost of larger tiles. Areas stay 64-bit, width * height of the canvas must fit in area_t.
+// The width is a build-time choice on purpose: one binary handles a single width, picking it per run would need Tile, Rectangle,
+// CornerStitching (and everything built on len_t: Rectilinear, Floorplan, the legaliser & refiner) templated on the coordinate
+// type, which is out of scope. Build one binary per width instead
+#ifdef COORDINATE_64BIT
+typedef int64_t len_t;
+#else
 typedef int32_t len_t;
+#endif
 typedef int64_t  area_t;
 
 typedef double flen_t;
@@ -7,6 +7,11 @@
 
 namespace DFSL{
 
+bool TileLowerLeftLess::operator()(const Tile *a, const Tile *b) const {
+    if (a->getXLow() != b->getXLow()) return a->getXLow() < b->getXLow();
+    return a->getYLow() < b->getYLow();
+}
+
 DFSLNode::DFSLNode():
     blockSet(NULL),
     nodeName(""), nodeType(DFSLNodeType::BLANK), index(-1), recti(NULL)
@@ -63,11 +68,11 @@ int DFSLNode::getArea(){
     return area;
 }
 
-std::unordered_set<Tile *>& DFSLNode::getBlockTileList(){
+TileList& DFSLNode::getBlockTileList(){
     return *(blockSet);
 }
 
-std::set<Tile *>& DFSLNode::getOverlapTileList(){
+OverlapTileSet& DFSLNode::getOverlapTileList(){
     return overlapTiles;
 }
 
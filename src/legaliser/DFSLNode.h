@@ -17,11 +17,18 @@ enum class DFSLNodeType : unsigned char { OVERLAP, FIXED, SOFT, BLANK };
 
 class DFSLNode;
 
+// orders overlap tiles by their lower-left corner, so walking an overlap node's tiles (and thus the legaliser's result)
+// does not depend on where the tiles happen to live in memory. A tile's lower-left must not change while it is in a set
+struct TileLowerLeftLess {
+    bool operator()(const Tile *a, const Tile *b) const;
+};
+typedef std::set<Tile *, TileLowerLeftLess> OverlapTileSet;
+
 class DFSLNode {
 private:
     // tileListUnion mTileListPtr;
-    std::unordered_set<Tile *>* blockSet;
-    std::set<Tile *> overlapTiles;
+    TileList* blockSet;
+    OverlapTileSet overlapTiles;
 public:
     std::string nodeName;
     DFSLNodeType nodeType;
@@ -36,8 +43,8 @@ public:
     DFSLNode(const DFSLNode& other);
     ~DFSLNode();
 
-    std::unordered_set<Tile *>& getBlockTileList();
-    std::set<Tile *>& getOverlapTileList();
+    TileList& getBlockTileList();
+    OverlapTileSet& getOverlapTileList();
 
     void addOverlapTile(Tile* newTile);
     // void removeTile(Tile* deleteTile);
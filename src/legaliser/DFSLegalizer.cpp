@@ -18,6 +18,9 @@
 
 namespace DFSL {
 
+// side of the neighbors walked for dir = 0 (top), 1 (right), 2 (bottom), 3 (left), as used by findTangentSegment
+static const direction2D dirSides[4] = {direction2D::UP, direction2D::RIGHT, direction2D::DOWN, direction2D::LEFT};
+
 DFSLegalizer::DFSLegalizer(): config(NULL)
 {
 }
@@ -135,7 +138,7 @@ void DFSLegalizer::constructGraph(){
 
 void DFSLegalizer::addOverlapInfo(Tile* tile){
     std::vector<int> allOverlaps;
-    for (Rectilinear* recti: mFP->overlapTilePayload[tile]){
+    for (Rectilinear* recti: tile->getOverlapPayload()){
         allOverlaps.push_back(recti->getId());
     }
 
@@ -198,27 +201,11 @@ void DFSLegalizer::findOBEdge(int fromIndex, int toIndex){
         // find Top, right, bottom, left neighbros
         std::vector<Segment> currentSegments;
         for (Tile* tile: fromNode.getOverlapTileList()){
-            std::vector<Tile*> neighbors;
-            switch (dir) {
-            case 0:
-                mFP->cs->findTopNeighbors(tile, neighbors);
-                break;
-            case 1:
-                mFP->cs->findRightNeighbors(tile, neighbors);
-                break;
-            case 2:
-                mFP->cs->findDownNeighbors(tile, neighbors);
-                break;
-            case 3:
-                mFP->cs->findLeftNeighbors(tile, neighbors);
-                break;
-            }
-            
-            for (Tile* neighbor: neighbors){
+            for (Tile* neighbor: mFP->cs->neighbors(tile, dirSides[dir])){
                 if (neighbor->getType() != tileType::BLOCK){
                     continue;
                 }
-                int nodeIndex = mFP->blockTilePayload[neighbor]->getId();
+                int nodeIndex = neighbor->getBlockPayload()->getId();
                 if (nodeIndex == toIndex){
                     currentSegments.push_back(findTangentSegment(tile, neighbor, dir));
                 }
@@ -277,23 +264,7 @@ void DFSLegalizer::getSoftNeighbors(int fromId){
         // find Top, right, bottom, left neighbros
         std::map<int, std::vector<Segment>> allCurrentTangentSegments;
         for (Tile* tile: fromNode.getBlockTileList()){
-            std::vector<Tile*> neighbors;
-            switch (dir) {
-            case 0:
-                mFP->cs->findTopNeighbors(tile, neighbors);
-                break;
-            case 1:
-                mFP->cs->findRightNeighbors(tile, neighbors);
-                break;
-            case 2:
-                mFP->cs->findDownNeighbors(tile, neighbors);
-                break;
-            case 3:
-                mFP->cs->findLeftNeighbors(tile, neighbors);
-                break;
-            }
-            
-            for (Tile* neighbor: neighbors){
+            for (Tile* neighbor: mFP->cs->neighbors(tile, dirSides[dir])){
                 // skip if neighbor is not block or whitespace
                 if (neighbor->getType() != tileType::BLOCK && neighbor->getType() != tileType::BLANK){
                     continue;
@@ -304,7 +275,7 @@ void DFSLegalizer::getSoftNeighbors(int fromId){
                     neighborBelongsTo = -1;
                 }
                 else{
-                    neighborBelongsTo = mFP->blockTilePayload[neighbor]->getId();
+                    neighborBelongsTo = neighbor->getBlockPayload()->getId();
                     int fixedBegin = getFixedBegin();
                     int fixedEnd = getFixedEnd();
                     // skip if neighbor belongs to fixed block
@@ -483,9 +454,9 @@ RESULT DFSLegalizer::legalize(int mode){
                     Cord chipCenter;
                     gtl::center(chipCenter, mFP->getChipContour());
                     
-                    int min_x, max_x, min_y, max_y;
-                    min_x = min_y = INT_MAX;
-                    max_x = max_y = -INT_MAX;
+                    len_t min_x, max_x, min_y, max_y;
+                    min_x = min_y = LEN_T_MAX;
+                    max_x = max_y = -LEN_T_MAX;
 
                     for (Tile* tile: currentOverlap.getOverlapTileList()){
                         if (tile->getXLow() < min_x){
@@ -501,8 +472,8 @@ RESULT DFSLegalizer::legalize(int mode){
                             max_y = tile->getYHigh();
                         }
                     }
-                    int overlapCenterx = (min_x + max_x) / 2;
-                    int overlapCentery = (min_y + max_y) / 2;
+                    len_t overlapCenterx = (min_x + max_x) / 2;
+                    len_t overlapCentery = (min_y + max_y) / 2;
                     int distSquared = pow(overlapCenterx - chipCenter.x(), 2) + pow(overlapCentery - chipCenter.y(), 2);
 
                     if (distSquared < bestMetric){
@@ -527,9 +498,9 @@ RESULT DFSLegalizer::legalize(int mode){
                     Cord chipCenter;
                     gtl::center(chipCenter, mFP->getChipContour());
                     
-                    int min_x, max_x, min_y, max_y;
-                    min_x = min_y = INT_MAX;
-                    max_x = max_y = -INT_MAX;
+                    len_t min_x, max_x, min_y, max_y;
+                    min_x = min_y = LEN_T_MAX;
+                    max_x = max_y = -LEN_T_MAX;
 
                     for (Tile* tile: currentOverlap.getOverlapTileList()){
                         if (tile->getXLow() < min_x){
@@ -545,8 +516,8 @@ RESULT DFSLegalizer::legalize(int mode){
                             max_y = tile->getYHigh();
                         }
                     }
-                    int overlapCenterx = (min_x + max_x) / 2;
-                    int overlapCentery = (min_y + max_y) / 2;
+                    len_t overlapCenterx = (min_x + max_x) / 2;
+                    len_t overlapCentery = (min_y + max_y) / 2;
                     int manDist = abs(overlapCenterx - chipCenter.x()) + abs(overlapCentery - chipCenter.y());
 
                     if (manDist < bestMetric){
@@ -841,8 +812,8 @@ void DFSLegalizer::legalizeAspectRatio(Rectilinear* recti, double aspectRatio){
     std::vector<Polygon90WithHoles> toDiscard;
     if (aspectRatio > this->mFP->getGlobalAspectRatioMax()){
         // too flat
-        int currentHeight = rec::getHeight(Bbox);
-        int maxWidth = floor((double)currentHeight * this->mFP->getGlobalAspectRatioMax());
+        len_t currentHeight = rec::getHeight(Bbox);
+        len_t maxWidth = floor((double)currentHeight * this->mFP->getGlobalAspectRatioMax());
 
         Rectangle range1(Bbox), range2(Bbox), range3(Bbox);
         // range1: cut off right
@@ -850,7 +821,7 @@ void DFSLegalizer::legalizeAspectRatio(Rectilinear* recti, double aspectRatio){
         // range2: cuh off left
         gtl::xl(range2, rec::getXH(Bbox) - maxWidth);
         // range3: stay in middle, cut off a bit of left and a bit of right
-        int xMiddle = (rec::getXL(Bbox) + rec::getXH(Bbox)) / 2;
+        len_t xMiddle = (rec::getXL(Bbox) + rec::getXH(Bbox)) / 2;
         gtl::xl(range3, xMiddle - maxWidth/2);
         gtl::xh(range3, xMiddle + maxWidth/2);
 
@@ -872,8 +843,8 @@ void DFSLegalizer::legalizeAspectRatio(Rectilinear* recti, double aspectRatio){
     }
     else {
         // too tall
-        int currentWidth = rec::getWidth(Bbox);
-        int maxHeight = floor((double)currentWidth / this->mFP->getGlobalAspectRatioMin());
+        len_t currentWidth = rec::getWidth(Bbox);
+        len_t maxHeight = floor((double)currentWidth / this->mFP->getGlobalAspectRatioMin());
 
         Rectangle range1(Bbox), range2(Bbox), range3(Bbox);
         // range1: cut off top
@@ -881,7 +852,7 @@ void DFSLegalizer::legalizeAspectRatio(Rectilinear* recti, double aspectRatio){
         // range2: cuh off bottom
         gtl::yl(range2, rec::getYH(Bbox) - maxHeight);
         // range3: stay in middle, cut off a bit of bottom and a bit of top
-        int yMiddle = (rec::getYL(Bbox) + rec::getYH(Bbox)) / 2;
+        len_t yMiddle = (rec::getYL(Bbox) + rec::getYH(Bbox)) / 2;
         gtl::yl(range3, yMiddle - maxHeight/2);
         gtl::yh(range3, yMiddle + maxHeight/2);
 
@@ -918,18 +889,19 @@ void DFSLegalizer::fillBoundingBox(Rectilinear* recti, Rectangle& rectBB){
 	// This stores the growing shape of rect during the growing process
 	DoughnutPolygonSet currentRectDPS;
 
-	DoughnutPolygonSet petriDishDPS, blankDPS;
+	DoughnutPolygonSet petriDishDPS;
 	petriDishDPS += rectBB;
-	blankDPS += rectBB;
+	// the white space inside the area comes straight from the blank tiles, one region per connected piece
+	std::vector<std::vector<Rectangle>> blankRegions;
+	this->mFP->cs->collectBlankRegions(rectBB, blankRegions);
 
 	// find all tiles that crosssect the area, find it and sieve those unfit
 	std::vector<Tile *> tilesinPetriDish;	
 	std::unordered_map<Rectilinear *, std::vector<Tile *>> invlovedTiles;
 	this->mFP->cs->enumerateDirectedArea(rectBB, tilesinPetriDish);
 	for(Tile *const &t : tilesinPetriDish){
-		Rectilinear *tilesRectilinear = this->mFP->blockTilePayload[t];
+		Rectilinear *tilesRectilinear = t->getBlockPayload();
 		Rectangle tileRectangle = t->getRectangle();
-		blankDPS -= tileRectangle;
 		if(tilesRectilinear->getType() == rectilinearType::PREPLACED) continue;
 		if(tilesRectilinear == recti){
 			currentRectDPS += tileRectangle;
@@ -949,12 +921,12 @@ void DFSLegalizer::fillBoundingBox(Rectilinear* recti, Rectangle& rectBB){
 		involvedRectilinears.push_back(it->first);
 	}
 
-	// start filling the candidates to grow	
-	std::vector<DoughnutPolygon> growCandidates;
+	// start filling the candidates to grow, each candidate is kept as disjoint rectangles
+	std::vector<std::vector<Rectangle>> growCandidates;
 	std::vector<Rectilinear *> growCandidatesRectilinear;
 	// start with the blank tiles 
-	for(int i = 0; i < blankDPS.size(); ++i){
-		growCandidates.push_back(blankDPS[i]);
+	for(std::vector<Rectangle> &blankRegion : blankRegions){
+		growCandidates.push_back(std::move(blankRegion));
 		growCandidatesRectilinear.push_back(nullptr);
 	}
 	// then those Rectiliears
@@ -966,14 +938,14 @@ void DFSLegalizer::fillBoundingBox(Rectilinear* recti, Rectangle& rectBB){
 		}
 		// trim those are out out of the bounding box
 		rectDPS &= rectBB;
-		int rectDPSSize = rectDPS.size();
-		for(int j = 0; j < rectDPSSize; ++j){
-			growCandidates.push_back(rectDPS[j]);
-			growCandidatesRectilinear.push_back(tgRect);
-		}
 		// put the larger block at first place
-		std::sort(growCandidates.end() - rectDPSSize, growCandidates.end(), 
+		std::sort(rectDPS.begin(), rectDPS.end(), 
 			[&](DoughnutPolygon a, DoughnutPolygon b){return boost::polygon::size(a) > boost::polygon::size(b);});
+		for(DoughnutPolygon const &rectDP : rectDPS){
+			growCandidates.push_back({});
+			dps::diceIntoRectangles(DoughnutPolygonSet(1, rectDP), growCandidates.back());
+			growCandidatesRectilinear.push_back(tgRect);
+		}
 		
 	}	
 	int growCandidateSize = growCandidates.size();
@@ -996,24 +968,24 @@ void DFSLegalizer::fillBoundingBox(Rectilinear* recti, Rectangle& rectBB){
 		for(int i = 0; i < growCandidateSize; ++i){
 			if(growCandidateSelect[i]) continue;
 
-			DoughnutPolygon markedDP = growCandidates[i];
+			const std::vector<Rectangle> &markedRectangles = growCandidates[i];
 			// test if installing this marked part would turn the current shape strange
 
 			DoughnutPolygonSet xSelfDPS(currentRectDPS);
             bool beforeNoGlitch = dps::innerWidthLegal(xSelfDPS);
-			xSelfDPS += markedDP;
+			xSelfDPS += markedRectangles;
             bool afterNoGlicth = dps::innerWidthLegal(xSelfDPS);
 			if((!dps::oneShape(xSelfDPS)) || (!dps::noHole(xSelfDPS)) || (beforeNoGlitch && (!afterNoGlicth))){
-				// intrducing the markedDP would cause dpSet to generate strange shape, give up on the tile
+				// intrducing the markedRectangles would cause dpSet to generate strange shape, give up on the tile
 				continue;
 			}
 
-			// test if pulling off the marked part would harm the victim too bad, skip if markedDP belongs to blank
+			// test if pulling off the marked part would harm the victim too bad, skip if markedRectangles belongs to blank
 			Rectilinear *victimRect = growCandidatesRectilinear[i];
 			if(victimRect != nullptr){
-				// markedDP belongs to other Rectilinear
+				// markedRectangles belongs to other Rectilinear
 				DoughnutPolygonSet xVictimDPS(rectCurrentShapeDPS[victimRect]);
-				xVictimDPS -= markedDP;
+				xVictimDPS -= markedRectangles;
 
 				// if removing the piece makes the victim rectilinear illegal, quit	
 				if(!dps::checkIsLegal(xVictimDPS, victimRect->getLegalArea(), this->mFP->getGlobalAspectRatioMin(), 
@@ -1026,11 +998,11 @@ void DFSLegalizer::fillBoundingBox(Rectilinear* recti, Rectangle& rectBB){
 			growCandidateSelect[i] = true;
 			keepGrowing = true;
 			hasGrow = true;
-			currentRectDPS += markedDP;
+			currentRectDPS += markedRectangles;
 			DoughnutPolygonSet markedDPS;
-			markedDPS += markedDP;
-			if(victimRect != nullptr){ // markedDP belongs to other Rectilienar
-				rectCurrentShapeDPS[victimRect] -= markedDP;
+			markedDPS += markedRectangles;
+			if(victimRect != nullptr){ // markedRectangles belongs to other Rectilienar
+				rectCurrentShapeDPS[victimRect] -= markedRectangles;
 				this->mFP->shrinkRectilinear(markedDPS, victimRect);
 			}
 			this->mFP->growRectilinear(markedDPS, recti);
@@ -1298,7 +1270,7 @@ bool DFSLegalizer::migrateOverlap(int overlapIndex){
             }
             else {
                 DFSLPrint(3, "Removing %s attribute from %d tiles:\n", toNode.nodeName.c_str(), fromNode.getOverlapTileList().size());
-                std::set<Tile*> overlapTilesCopy = fromNode.getOverlapTileList();
+                OverlapTileSet overlapTilesCopy = fromNode.getOverlapTileList();
                 for (Tile* overlap: overlapTilesCopy){
                     DFSLPrint(3, "\t%1%\n", *(overlap));
                     removeTileFromOverlap(overlap, fromNode, toNode);
@@ -1641,13 +1613,13 @@ MigrationEdge DFSLegalizer::getEdgeCost(DFSLEdge& edge){
             Segment seg = tangentSegments[s];
             Segment wall = FindNearestOverlappingInterval(seg, toBlock);
             len_t Blx, Bly;
-            int width;
-            int height;
+            len_t width;
+            len_t height;
             DFSLPrint(4, ">> SEG: %1%\t WALL: %2%\n", seg, wall);
             if (seg.getDirection() == DIRECTION::TOP){
                 width = seg.getLength();
-                int requiredHeight = ceil((double) mMigratingArea / (double) width);
-                int availableHeight = wall.getSegStart().y() - seg.getSegStart().y();
+                len_t requiredHeight = ceil((double) mMigratingArea / (double) width);
+                len_t availableHeight = wall.getSegStart().y() - seg.getSegStart().y();
                 assert(availableHeight > 0);
                 height = availableHeight > requiredHeight ? requiredHeight : availableHeight;
                 Blx = seg.getSegStart().x();
@@ -1655,8 +1627,8 @@ MigrationEdge DFSLegalizer::getEdgeCost(DFSLEdge& edge){
             }
             else if (seg.getDirection() == DIRECTION::RIGHT){
                 height = seg.getLength();
-                int requiredWidth = ceil((double) mMigratingArea / (double) height);
-                int availableWidth = wall.getSegStart().x() - seg.getSegStart().x();
+                len_t requiredWidth = ceil((double) mMigratingArea / (double) height);
+                len_t availableWidth = wall.getSegStart().x() - seg.getSegStart().x();
                 assert(availableWidth > 0);
                 width = availableWidth > requiredWidth ? requiredWidth : availableWidth;
                 Blx = seg.getSegStart().x();
@@ -1664,8 +1636,8 @@ MigrationEdge DFSLegalizer::getEdgeCost(DFSLEdge& edge){
             }
             else if (seg.getDirection() == DIRECTION::DOWN){
                 width = seg.getLength();
-                int requiredHeight = ceil((double) mMigratingArea / (double) width);
-                int availableHeight = seg.getSegStart().y() - wall.getSegStart().y();
+                len_t requiredHeight = ceil((double) mMigratingArea / (double) width);
+                len_t availableHeight = seg.getSegStart().y() - wall.getSegStart().y();
                 assert(availableHeight > 0);
                 height = availableHeight > requiredHeight ? requiredHeight : availableHeight;
                 Blx = seg.getSegStart().x();
@@ -1673,8 +1645,8 @@ MigrationEdge DFSLegalizer::getEdgeCost(DFSLEdge& edge){
             }
             else if (seg.getDirection() == DIRECTION::LEFT) {
                 height = seg.getLength();
-                int requiredWidth = ceil((double) mMigratingArea / (double) height);
-                int availableWidth = seg.getSegStart().x() - wall.getSegStart().x();
+                len_t requiredWidth = ceil((double) mMigratingArea / (double) height);
+                len_t availableWidth = seg.getSegStart().x() - wall.getSegStart().x();
                 assert(availableWidth > 0);
                 width = availableWidth > requiredWidth ? requiredWidth : availableWidth;
                 Blx = seg.getSegStart().x() - width;
@@ -1850,7 +1822,7 @@ bool DFSLegalizer::splitOverlap(MigrationEdge& edge, std::vector<Tile*>& newTile
 
 
     // From ascending order of area, resolve each overlap tile individually 
-    std::set<Tile*>& overlapTileList = fromNode.getOverlapTileList();
+    OverlapTileSet& overlapTileList = fromNode.getOverlapTileList();
     std::vector<bool> tileChosen(overlapTileList.size(), false);
     int remainingMigrateArea = mResolvableArea;
     Tile* smallestTile = NULL;
@@ -1885,62 +1857,77 @@ bool DFSLegalizer::splitOverlap(MigrationEdge& edge, std::vector<Tile*>& newTile
             Rectangle bestRectangle;
             if (!sideOccupied[0]){
                 // grow from top side
-                int width = smallestTile->getWidth();
-                int height = (int) floor((double) remainingMigrateArea / (double) width);
+                len_t width = smallestTile->getWidth();
+                len_t height = (len_t) floor((double) remainingMigrateArea / (double) width);
                 int thisArea = width * height;
                 if (thisArea > closestArea){
                     closestArea = thisArea;
                     bestDirection = DIRECTION::TOP;
 
-                    int newYl = smallestTile->getYHigh() - height;
+                    len_t newYl = smallestTile->getYHigh() - height;
                     bestRectangle = smallestTile->getRectangle();
                     gtl::yl(bestRectangle, newYl);
                 }
             }
             if (!sideOccupied[1]){
                 // grow from right side
-                int height = smallestTile->getHeight();
-                int width = (int) floor((double) remainingMigrateArea / (double) height);
+                len_t height = smallestTile->getHeight();
+                len_t width = (len_t) floor((double) remainingMigrateArea / (double) height);
                 int thisArea = width * height;
                 if (thisArea > closestArea){
                     closestArea = thisArea;
                     bestDirection = DIRECTION::RIGHT;
 
-                    int newXl = smallestTile->getXHigh() - width;
+                    len_t newXl = smallestTile->getXHigh() - width;
                     bestRectangle = smallestTile->getRectangle();
                     gtl::xl(bestRectangle, newXl);
                 }
             }
             if (!sideOccupied[2]){
                 // grow from bottom side
-                int width = smallestTile->getWidth();
-                int height = (int) floor((double) remainingMigrateArea / (double) width);
+                len_t width = smallestTile->getWidth();
+                len_t height = (len_t) floor((double) remainingMigrateArea / (double) width);
                 int thisArea = width * height;
                 if (thisArea > closestArea){
                     closestArea = thisArea;
                     bestDirection = DIRECTION::DOWN;
 
-                    int newYh = smallestTile->getYLow() + height;
+                    len_t newYh = smallestTile->getYLow() + height;
                     bestRectangle = smallestTile->getRectangle();
                     gtl::yh(bestRectangle, newYh);
                 }
             }
             if (!sideOccupied[3]){
                 // grow from left side
-                int height = smallestTile->getHeight();
-                int width = (int) floor((double) remainingMigrateArea / (double) height);
+                len_t height = smallestTile->getHeight();
+                len_t width = (len_t) floor((double) remainingMigrateArea / (double) height);
                 int thisArea = width * height;
                 if (thisArea > closestArea){
                     closestArea = thisArea;
                     bestDirection = DIRECTION::LEFT;
 
-                    int newXh = smallestTile->getXLow() + width;
+                    len_t newXh = smallestTile->getXLow() + width;
                     bestRectangle = smallestTile->getRectangle();
                     gtl::xh(bestRectangle, newXh);
                 }
             }
             
             if (closestArea > 0){
+                // a TOP or RIGHT split moves smallestTile's lower-left, the key of the overlap tile sets:
+                // take it out of every set holding it before the split and put it back afterwards
+                std::vector<OverlapTileSet*> holdingSets;
+                for (int i = getOverlapBegin(); i < getOverlapEnd(); i++){
+                    OverlapTileSet& overlapList = mAllNodes[i].getOverlapTileList();
+                    if (overlapList.erase(smallestTile) == 1){
+                        holdingSets.push_back(&overlapList);
+                    }
+                }
+                auto reattachSmallestTile = [&](){
+                    for (OverlapTileSet* overlapList: holdingSets){
+                        overlapList->insert(smallestTile);
+                    }
+                };
+
                 Tile* newTile = NULL;
                 switch (bestDirection){
                     case DIRECTION::TOP:{
@@ -1948,6 +1935,7 @@ bool DFSLegalizer::splitOverlap(MigrationEdge& edge, std::vector<Tile*>& newTile
                         Tile* newTopOverlap = mFP->generalSplitTile(smallestTile, bestRectangle);
                         Tile* newBottomOverlap = newTopOverlap->lb;
                         // manually update overlapTileList
+                        reattachSmallestTile();
                         fromNode.getOverlapTileList().insert(newBottomOverlap);
 
                         removeTileFromOverlap(newTopOverlap, fromNode, toNode);
@@ -1959,6 +1947,7 @@ bool DFSLegalizer::splitOverlap(MigrationEdge& edge, std::vector<Tile*>& newTile
                         Tile* newRightOverlap = mFP->generalSplitTile(smallestTile, bestRectangle);
                         Tile* newLeftOverlap = newRightOverlap->bl;
                         // manually update overlapTileList
+                        reattachSmallestTile();
                         fromNode.getOverlapTileList().insert(newLeftOverlap);
 
                         removeTileFromOverlap(newRightOverlap, fromNode, toNode);
@@ -1970,6 +1959,7 @@ bool DFSLegalizer::splitOverlap(MigrationEdge& edge, std::vector<Tile*>& newTile
                         Tile* newBottomOverlap = mFP->generalSplitTile(smallestTile, bestRectangle);
                         Tile* newTopOverlap = newBottomOverlap->rt;
                         // manually update overlapTileList
+                        reattachSmallestTile();
                         fromNode.getOverlapTileList().insert(newTopOverlap);
 
                         removeTileFromOverlap(newBottomOverlap, fromNode, toNode);
@@ -1981,6 +1971,7 @@ bool DFSLegalizer::splitOverlap(MigrationEdge& edge, std::vector<Tile*>& newTile
                         Tile* newLeftOverlap = mFP->generalSplitTile(smallestTile, bestRectangle);
                         Tile* newRightOverlap = newLeftOverlap->tr;
                         // manually update overlapTileList
+                        reattachSmallestTile();
                         fromNode.getOverlapTileList().insert(newRightOverlap);
 
                         removeTileFromOverlap(newLeftOverlap, fromNode, toNode);
@@ -2063,9 +2054,9 @@ bool DFSLegalizer::splitOverlap(MigrationEdge& edge, std::vector<Tile*>& newTile
 }
 
 void DFSLegalizer::removeTileFromOverlap(Tile* tile, DFSLNode& overlapNode, DFSLNode& toNode){
-    std::vector<Rectilinear*> belongsToOverlaps = mFP->overlapTilePayload[tile];
+    OverlapPayload belongsToOverlaps = tile->getOverlapPayload();
     if (belongsToOverlaps.size() == 2){
-        std::set<Tile*>& overlapList = overlapNode.getOverlapTileList();
+        OverlapTileSet& overlapList = overlapNode.getOverlapTileList();
         auto iter = overlapList.find(tile);
         assert(iter != overlapList.end());
         overlapList.erase(iter);
@@ -2087,7 +2078,7 @@ void DFSLegalizer::removeTileFromOverlap(Tile* tile, DFSLNode& overlapNode, DFSL
             DFSLNode& overlapNode = mAllNodes[i];
             for (int overlapIndex2: overlapsToRemoveFrom){
                 if (overlapNode.overlaps.count(overlapIndex1) == 1 && overlapNode.overlaps.count(overlapIndex2) == 1){
-                    std::set<Tile*>& overlapList = overlapNode.getOverlapTileList();
+                    OverlapTileSet& overlapList = overlapNode.getOverlapTileList();
                     auto iter = overlapList.find(tile);
                     assert(iter != overlapList.end());
                     overlapList.erase(iter);
@@ -2468,6 +2459,10 @@ static std::array<Rectangle,2> getRectFromEdgeExact(MigrationEdge& edge, int goa
     return {bigRect, remainderRect};
 }
 
+// Largest blank rectangle (up to requiredArea, within the chip) extending from seg toward its direction, see CornerStitching::findBlankExtension.
+// If a nonblank tile lies right in front of seg the result is empty; this never happens for the tangent segments of BW edges, which come
+// from walking the blank neighbors of the block. (Before the query moved into CornerStitching an obstacle straddling seg produced a
+// rectangle flipped to the back side of seg instead)
 static Rectangle extendSegment(Segment& seg, int requiredArea, Floorplan* fp){
     int xl, xh, yl, yh;
     Rectangle resultRectangle;
@@ -2482,17 +2477,7 @@ static Rectangle extendSegment(Segment& seg, int requiredArea, Floorplan* fp){
         yh = yh > rec::getYH(fp->getChipContour()) ? rec::getYH(fp->getChipContour()) : yh;
 
         Rectangle goalRect(xl,yl,xh,yh);
-        std::vector<Tile*> obstacles;
-        fp->cs->enumerateDirectedArea(goalRect, obstacles);
-
-        int lowestObstacle = yh;
-        for (Tile* tile: obstacles){
-            if (tile->getYLow() < lowestObstacle){
-                lowestObstacle = tile->getYLow();
-            }
-        }
-
-        resultRectangle = Rectangle(xl,yl,xh,lowestObstacle);
+        resultRectangle = fp->cs->findBlankExtension(goalRect, direction2D::UP);
     }
     else if (seg.getDirection() == DIRECTION::RIGHT){
         yl = seg.getSegStart().y();
@@ -2504,17 +2489,7 @@ static Rectangle extendSegment(Segment& seg, int requiredArea, Floorplan* fp){
         xh = xh > rec::getXH(fp->getChipContour()) ? rec::getXH(fp->getChipContour()) : xh;
 
         Rectangle goalRect(xl,yl,xh,yh);
-        std::vector<Tile*> obstacles;
-        fp->cs->enumerateDirectedArea(goalRect, obstacles);
-
-        int leftmostObstacle = xh;
-        for (Tile* tile: obstacles){
-            if (tile->getXLow() < leftmostObstacle){
-                leftmostObstacle = tile->getXLow();
-            }
-        }
-
-        resultRectangle = Rectangle(xl,yl,leftmostObstacle,yh);
+        resultRectangle = fp->cs->findBlankExtension(goalRect, direction2D::RIGHT);
     }
     else if (seg.getDirection() == DIRECTION::DOWN){
         xl = seg.getSegStart().x();
@@ -2526,17 +2501,7 @@ static Rectangle extendSegment(Segment& seg, int requiredArea, Floorplan* fp){
         yl = yl < 0 ? 0 : yl;
 
         Rectangle goalRect(xl,yl,xh,yh);
-        std::vector<Tile*> obstacles;
-        fp->cs->enumerateDirectedArea(goalRect, obstacles);
-
-        int highestObstacle = yl;
-        for (Tile* tile: obstacles){
-            if (tile->getYHigh() > highestObstacle){
-                highestObstacle = tile->getYHigh();
-            }
-        }
-
-        resultRectangle = Rectangle(xl,highestObstacle,xh,yh);
+        resultRectangle = fp->cs->findBlankExtension(goalRect, direction2D::DOWN);
     }
     else if (seg.getDirection() == DIRECTION::LEFT) {
         yl = seg.getSegStart().y();
@@ -2548,17 +2513,7 @@ static Rectangle extendSegment(Segment& seg, int requiredArea, Floorplan* fp){
         xl = xl < 0 ? 0 : xl;
 
         Rectangle goalRect(xl,yl,xh,yh);
-        std::vector<Tile*> obstacles;
-        fp->cs->enumerateDirectedArea(goalRect, obstacles);
-
-        int rightmostObstacle = xl;
-        for (Tile* tile: obstacles){
-            if (tile->getXHigh() > rightmostObstacle){
-                rightmostObstacle = tile->getXHigh();
-            }
-        }
-
-        resultRectangle = Rectangle(rightmostObstacle,yl,xh,yh);
+        resultRectangle = fp->cs->findBlankExtension(goalRect, direction2D::LEFT);
     }
     else {
         std::cerr << "extendSegment: edge has no DIRECTION\n";
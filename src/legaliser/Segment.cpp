@@ -29,7 +29,7 @@ Segment::Segment(const Segment& other){
     this->direction = other.direction;
 }
 
-int Segment::getLength() const {
+len_t Segment::getLength() const {
     return gtl::euclidean_distance(segStart, segEnd);
 }
 
@@ -93,7 +93,7 @@ std::ostream& operator<<(std::ostream& out, const Segment& seg){
 Segment FindNearestOverlappingInterval(Segment& seg, Polygon90Set& poly){
     int segmentOrientation; // 0 = segments are X direction, 1 = Y direction
     Segment closestSegment = seg;
-    int closestDistance = INT_MAX;
+    len_t closestDistance = LEN_T_MAX;
     if (seg.getDirection() == DIRECTION::DOWN || seg.getDirection() == DIRECTION::TOP){
         segmentOrientation = 0;
     }
@@ -133,7 +133,7 @@ Segment FindNearestOverlappingInterval(Segment& seg, Polygon90Set& poly){
                     bool overlaps = ((currentSegment.getSegStart().x() < seg.getSegEnd().x()) && (seg.getSegStart().x() < currentSegment.getSegEnd().x()));
                     bool isAbove = currentSegment.getSegStart().y() > seg.getSegStart().y();
                     if (overlaps && isAbove){
-                        int distance = currentSegment.getSegStart().y() - seg.getSegStart().y();
+                        len_t distance = currentSegment.getSegStart().y() - seg.getSegStart().y();
                         if (distance < closestDistance){
                             closestDistance = distance;
                             closestSegment = currentSegment;
@@ -147,7 +147,7 @@ Segment FindNearestOverlappingInterval(Segment& seg, Polygon90Set& poly){
                     bool overlaps = ((currentSegment.getSegStart().y() < seg.getSegEnd().y()) && (seg.getSegStart().y() < currentSegment.getSegEnd().y()));
                     bool isRight = currentSegment.getSegStart().x() > seg.getSegStart().x();
                     if (overlaps && isRight){
-                        int distance = currentSegment.getSegStart().x() - seg.getSegStart().x();
+                        len_t distance = currentSegment.getSegStart().x() - seg.getSegStart().x();
                         if (distance < closestDistance){
                             closestDistance = distance;
                             closestSegment = currentSegment;
@@ -161,7 +161,7 @@ Segment FindNearestOverlappingInterval(Segment& seg, Polygon90Set& poly){
                     bool overlaps = ((currentSegment.getSegStart().x() < seg.getSegEnd().x()) && (seg.getSegStart().x() < currentSegment.getSegEnd().x()));
                     bool isBelow = currentSegment.getSegStart().y() < seg.getSegStart().y();
                     if (overlaps && isBelow){
-                        int distance = seg.getSegStart().y() -currentSegment.getSegStart().y();
+                        len_t distance = seg.getSegStart().y() -currentSegment.getSegStart().y();
                         if (distance < closestDistance){
                             closestDistance = distance;
                             closestSegment = currentSegment;
@@ -175,7 +175,7 @@ Segment FindNearestOverlappingInterval(Segment& seg, Polygon90Set& poly){
                     bool overlaps = ((currentSegment.getSegStart().y() < seg.getSegEnd().y()) && (seg.getSegStart().y() < currentSegment.getSegEnd().y()));
                     bool isLeft = currentSegment.getSegStart().x() < seg.getSegStart().x();
                     if (overlaps && isLeft){
-                        int distance = seg.getSegStart().x() - currentSegment.getSegStart().x();
+                        len_t distance = seg.getSegStart().x() - currentSegment.getSegStart().x();
                         if (distance < closestDistance){
                             closestDistance = distance;
                             closestSegment = currentSegment;
@@ -205,7 +205,7 @@ Segment FindNearestOverlappingInterval(Segment& seg, Polygon90Set& poly){
                 bool overlaps = ((lastSegment.getSegStart().x() < seg.getSegEnd().x()) && (seg.getSegStart().x() < lastSegment.getSegEnd().x()));
                 bool isAbove = lastSegment.getSegStart().y() > seg.getSegStart().y();
                 if (overlaps && isAbove){
-                    int distance = lastSegment.getSegStart().y() - seg.getSegStart().y();
+                    len_t distance = lastSegment.getSegStart().y() - seg.getSegStart().y();
                     if (distance < closestDistance){
                         closestDistance = distance;
                         closestSegment = lastSegment;
@@ -219,7 +219,7 @@ Segment FindNearestOverlappingInterval(Segment& seg, Polygon90Set& poly){
                 bool overlaps = ((lastSegment.getSegStart().y() < seg.getSegEnd().y()) && (seg.getSegStart().y() < lastSegment.getSegEnd().y()));
                 bool isRight = lastSegment.getSegStart().x() > seg.getSegStart().x();
                 if (overlaps && isRight){
-                    int distance = lastSegment.getSegStart().x() - seg.getSegStart().x();
+                    len_t distance = lastSegment.getSegStart().x() - seg.getSegStart().x();
                     if (distance < closestDistance){
                         closestDistance = distance;
                         closestSegment = lastSegment;
@@ -233,7 +233,7 @@ Segment FindNearestOverlappingInterval(Segment& seg, Polygon90Set& poly){
                 bool overlaps = ((lastSegment.getSegStart().x() < seg.getSegEnd().x()) && (seg.getSegStart().x() < lastSegment.getSegEnd().x()));
                 bool isBelow = lastSegment.getSegStart().y() < seg.getSegStart().y();
                 if (overlaps && isBelow){
-                    int distance = seg.getSegStart().y() -lastSegment.getSegStart().y();
+                    len_t distance = seg.getSegStart().y() -lastSegment.getSegStart().y();
                     if (distance < closestDistance){
                         closestDistance = distance;
                         closestSegment = lastSegment;
@@ -247,7 +247,7 @@ Segment FindNearestOverlappingInterval(Segment& seg, Polygon90Set& poly){
                 bool overlaps = ((lastSegment.getSegStart().y() < seg.getSegEnd().y()) && (seg.getSegStart().y() < lastSegment.getSegEnd().y()));
                 bool isLeft = lastSegment.getSegStart().x() < seg.getSegStart().x();
                 if (overlaps && isLeft){
-                    int distance = seg.getSegStart().x() - lastSegment.getSegStart().x();
+                    len_t distance = seg.getSegStart().x() - lastSegment.getSegStart().x();
                     if (distance < closestDistance){
                         closestDistance = distance;
                         closestSegment = lastSegment;
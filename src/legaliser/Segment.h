@@ -25,7 +25,7 @@ public:
     Segment(Cord start, Cord end);
     Segment(const Segment& other);
     Segment();
-    int getLength() const ;
+    len_t getLength() const ;
     Cord getSegStart() const ;
     Cord getSegEnd() const ;   
     DIRECTION getDirection() const ;
@@ -226,11 +226,17 @@ int main(int argc, char *argv[]) {
 	}
 
 	/* PHASE 4: DFSL Legaliser: Overlap Migration via Graph Traversal */
+	floorplan->relayoutTiles();
 	runLegalization(floorplan);
     // floorplan->visualiseFloorplan("./outputs/case02-legalized.txt");
 
 PHASE_REFINE_ENGINE:{
 	std::cout << std::endl;	
+	// earlier phases leave rectilinears fragmented, merge tiles before the refinement engine starts copying floorplans
+	size_t tileCountBefore, tileCountAfter;
+	floorplan->compactTiles(tileCountBefore, tileCountAfter);
+	std::cout << "[TileCompaction] Complete, non-blank tiles " << tileCountBefore << " -> " << tileCountAfter << std::endl << std::endl;
+	floorplan->relayoutTiles();
         /* PHASE 5: Refinement Engine */
 	if(bool(REFINE_ENGINE_GRID_SEARCH)){
         bool refineBestFloorplanisFather = true;
@@ -269,11 +275,10 @@ PHASE_REFINE_ENGINE:{
                 bool expShrinkGradient = xGradient % 2;
                 for(int xGradientOrder = 0; xGradientOrder < 2; ++xGradientOrder){
                     bool expUseGradientOrder = bool(xGradientOrder);
-                    Floorplan *expFloorplan = new Floorplan(*floorplan);
-
+                    // every experiment starts from floorplan: the engine refines its own copy, expFloorplan belongs to us
                     std::chrono::steady_clock::time_point expStartTime = std::chrono::steady_clock::now();
-                    RefineEngine expRF(expFloorplan, 30,expUseGradientOrder, expMomentum, expMomentumGrowth, expGrowGradient, expShrinkGradient);
-                    expFloorplan = expRF.refine();
+                    RefineEngine expRF(floorplan, 30,expUseGradientOrder, expMomentum, expMomentumGrowth, expGrowGradient, expShrinkGradient, true);
+                    Floorplan *expFloorplan = expRF.refine();
                     std::chrono::steady_clock::time_point expEndTime = std::chrono::steady_clock::now();
 
                     flen_t expResult = expFloorplan->calculateHPWL();
@@ -328,7 +333,7 @@ PHASE_REFINE_ENGINE:{
         TIME_POINT_START_REF = std::chrono::steady_clock::now();
         // RefineEngine refineEngine(floorplan, 0.3, 30, false, 2, 1.75, true, false);
         RefineEngine refineEngine(floorplan, int(HYPERPARAM_REF_MAX_ITERATION), bool(HYPERPARAM_REF_USE_GRADIENT_ORDER),
-			len_t(HYPERPARAM_REF_INITIAL_MOMENTUM), HYPERPARAM_REF_MOMENTUM_GROWTH, bool(HYPERPARAM_REF_USE_GRADIENT_GROW), bool(HYPERPARAM_REF_USE_GRADIENT_SHRINK));
+			len_t(HYPERPARAM_REF_INITIAL_MOMENTUM), HYPERPARAM_REF_MOMENTUM_GROWTH, bool(HYPERPARAM_REF_USE_GRADIENT_GROW), bool(HYPERPARAM_REF_USE_GRADIENT_SHRINK), false);
 
         floorplan = refineEngine.refine();
         TIME_POINT_END_REF = std::chrono::steady_clock::now();
@@ -523,7 +528,7 @@ void runLegalization(Floorplan *&floorplan){
 void runRerineEngine(Floorplan *&floorplan){
 	TIME_POINT_START_REF = std::chrono::steady_clock::now();
 	// RefineEngine refineEngine(floorplan, 0.3, 30, false, 2, 1.75, true, false);
-	RefineEngine refineEngine(floorplan, 30, false, 2, 1.75, true, true);
+	RefineEngine refineEngine(floorplan, 30, false, 2, 1.75, true, true, false);
 
 	floorplan = refineEngine.refine();
 	TIME_POINT_END_REF = std::chrono::steady_clock::now();
@@ -3,10 +3,11 @@
 #include "cSException.h"
 #include "colours.h"
 
-RefineEngine::RefineEngine(Floorplan *floorplan, int maxIter, bool useGradientOrder, len_t initMomentum, double momentumGrowth, bool growGradient, bool shrinkGradient)
+RefineEngine::RefineEngine(Floorplan *floorplan, int maxIter, bool useGradientOrder, len_t initMomentum, double momentumGrowth, bool growGradient, bool shrinkGradient,
+							bool keepOriginal)
 	: REFINE_MAX_ITERATION(maxIter), REFINE_USE_GRADIENT_ORDER(useGradientOrder),
 	REFINE_INITIAL_MOMENTUM(initMomentum), REFINE_MOMENTUM_GROWTH(momentumGrowth), REFINE_USE_GRADIENT_GROW(growGradient), REFINE_USE_GRADIENT_SHRINK(shrinkGradient) {
-    this->fp = floorplan;
+    this->fp = (keepOriginal)? new Floorplan(*floorplan) : floorplan;
     for(Rectilinear *const &rt : fp->softRectilinears){
         rectConnOrder.push_back(rt);
         std::unordered_map<Rectilinear *, std::vector<Connection *>>::iterator it = fp->connectionMap.find(rt);
@@ -32,7 +33,8 @@ Floorplan *RefineEngine::refine(){
 	double hpwlDeltaRecord[3] = {-1, -2, -3};
 
 	double bestHPWL = initialHPWL;
-	Floorplan *bestFloorplan = new Floorplan(*fp);
+	// snapshots are O(1) journal marks, fp is brought back to the best one when refining is done
+	size_t bestSnapshot = fp->takeSnapshot();
 
 	double iterationHPWLRecord = initialHPWL;
     while(hasMovement){
@@ -74,8 +76,8 @@ Floorplan *RefineEngine::refine(){
 				double currenthpwl = fp->calculateHPWL();
 				if(currenthpwl < bestHPWL){
 					bestHPWL = currenthpwl;
-					delete bestFloorplan;
-					bestFloorplan = new Floorplan(*fp);
+					fp->releaseSnapshot(bestSnapshot);
+					bestSnapshot = fp->takeSnapshot();
 
 				}
 			}
@@ -106,7 +108,9 @@ Floorplan *RefineEngine::refine(){
 
 		if((++iterationCounter) == REFINE_MAX_ITERATION) break;
     }
-	return bestFloorplan;
+	fp->restoreSnapshot(bestSnapshot);
+	fp->releaseSnapshot(bestSnapshot);
+	return fp;
 
 }
 
@@ -187,18 +191,19 @@ bool RefineEngine::fillBoundingBox(Rectilinear *rect) const {
 
 	Rectangle rectBB = rect->calculateBoundingBox();
 
-	DoughnutPolygonSet petriDishDPS, blankDPS;
+	DoughnutPolygonSet petriDishDPS;
 	petriDishDPS += rectBB;
-	blankDPS += rectBB;
+	// the white space inside the area comes straight from the blank tiles, one region per connected piece
+	std::vector<std::vector<Rectangle>> blankRegions;
+	fp->cs->collectBlankRegions(rectBB, blankRegions);
 
 	// find all tiles that crosssect the area, find it and sieve those unfit
 	std::vector<Tile *> tilesinPetriDish;	
 	std::unordered_map<Rectilinear *, std::vector<Tile *>> invlovedTiles;
 	fp->cs->enumerateDirectedArea(rectBB, tilesinPetriDish);
 	for(Tile *const &t : tilesinPetriDish){
-		Rectilinear *tilesRectilinear = fp->blockTilePayload[t];
+		Rectilinear *tilesRectilinear = t->getBlockPayload();
 		Rectangle tileRectangle = t->getRectangle();
-		blankDPS -= tileRectangle;
 		if(tilesRectilinear->getType() == rectilinearType::PREPLACED) continue;
 		if(tilesRectilinear == rect){
 			currentRectDPS += tileRectangle;
@@ -218,12 +223,12 @@ bool RefineEngine::fillBoundingBox(Rectilinear *rect) const {
 		involvedRectilinears.push_back(it->first);
 	}
 
-	// start filling the candidates to grow	
-	std::vector<DoughnutPolygon> growCandidates;
+	// start filling the candidates to grow, each candidate is kept as disjoint rectangles
+	std::vector<std::vector<Rectangle>> growCandidates;
 	std::vector<Rectilinear *> growCandidatesRectilinear;
 	// start with the blank tiles 
-	for(int i = 0; i < blankDPS.size(); ++i){
-		growCandidates.push_back(blankDPS[i]);
+	for(std::vector<Rectangle> &blankRegion : blankRegions){
+		growCandidates.push_back(std::move(blankRegion));
 		growCandidatesRectilinear.push_back(nullptr);
 	}
 	// then those Rectiliears
@@ -235,14 +240,14 @@ bool RefineEngine::fillBoundingBox(Rectilinear *rect) const {
 		}
 		// trim those are out out of the bounding box
 		rectDPS &= rectBB;
-		int rectDPSSize = rectDPS.size();
-		for(int j = 0; j < rectDPSSize; ++j){
-			growCandidates.push_back(rectDPS[j]);
-			growCandidatesRectilinear.push_back(tgRect);
-		}
 		// put the larger block at first place
-		std::sort(growCandidates.end() - rectDPSSize, growCandidates.end(), 
+		std::sort(rectDPS.begin(), rectDPS.end(), 
 			[&](DoughnutPolygon a, DoughnutPolygon b){return boost::polygon::size(a) > boost::polygon::size(b);});
+		for(DoughnutPolygon const &rectDP : rectDPS){
+			growCandidates.push_back({});
+			dps::diceIntoRectangles(DoughnutPolygonSet(1, rectDP), growCandidates.back());
+			growCandidatesRectilinear.push_back(tgRect);
+		}
 		
 	}	
 	int growCandidateSize = growCandidates.size();
@@ -268,23 +273,23 @@ bool RefineEngine::fillBoundingBox(Rectilinear *rect) const {
 		for(int i = 0; i < growCandidateSize; ++i){
 			if(growCandidateSelect[i]) continue;
 
-			DoughnutPolygon markedDP = growCandidates[i];
+			const std::vector<Rectangle> &markedRectangles = growCandidates[i];
 			// test if installing this marked part would turn the current shape strange
 
 			DoughnutPolygonSet xSelfDPS(currentRectDPS);
-			xSelfDPS += markedDP;
+			xSelfDPS += markedRectangles;
 			// April 29, 2024: Add inner Width constraint
 			if(!(dps::oneShape(xSelfDPS) && dps::noHole(xSelfDPS) && dps::innerWidthLegal(xSelfDPS))){
-				// intrducing the markedDP would cause dpSet to generate strange shape, give up on the tile
+				// intrducing the markedRectangles would cause dpSet to generate strange shape, give up on the tile
 				continue;
 			}
 
-			// test if pulling off the marked part would harm the victim too bad, skip if markedDP belongs to blank
+			// test if pulling off the marked part would harm the victim too bad, skip if markedRectangles belongs to blank
 			Rectilinear *victimRect = growCandidatesRectilinear[i];
 			if(victimRect != nullptr){
-				// markedDP belongs to other Rectilinear
+				// markedRectangles belongs to other Rectilinear
 				DoughnutPolygonSet xVictimDPS(rectCurrentShapeDPS[victimRect]);
-				xVictimDPS -= markedDP;
+				xVictimDPS -= markedRectangles;
 
 				if(!dps::checkIsLegal(xVictimDPS, victimRect->getLegalArea(), this->fp->getGlobalAspectRatioMin(), 
 				this->fp->getGlobalAspectRatioMax(), this->fp->getGlobalUtilizationMin())){
@@ -299,11 +304,11 @@ bool RefineEngine::fillBoundingBox(Rectilinear *rect) const {
 			growCandidateSelect[i] = true;
 			keepGrowing = true;
 			hasGrow = true;
-			currentRectDPS += markedDP;
+			currentRectDPS += markedRectangles;
 			DoughnutPolygonSet markedDPS;
-			markedDPS += markedDP;
-			if(victimRect != nullptr){ // markedDP belongs to other Rectilienar
-				rectCurrentShapeDPS[victimRect] -= markedDP;
+			markedDPS += markedRectangles;
+			if(victimRect != nullptr){ // markedRectangles belongs to other Rectilienar
+				rectCurrentShapeDPS[victimRect] -= markedRectangles;
 				fp->shrinkRectilinear(markedDPS, victimRect);
 			}
 			fp->growRectilinear(markedDPS, rect);
@@ -1480,18 +1485,18 @@ std::unordered_map<Rectilinear *, DoughnutPolygonSet> &affectedNeighbors) const{
 	using namespace boost::polygon::operators;
 
 	Rectangle rectBB = rect->calculateBoundingBox();
-	DoughnutPolygonSet petriDishDPS, blankDPS;
+	DoughnutPolygonSet petriDishDPS;
 	petriDishDPS += rectBB;
-	blankDPS += rectBB;
+	// the white space inside the area comes straight from the blank tiles, one region per connected piece
+	std::vector<std::vector<Rectangle>> blankRegions;
+	fp->cs->collectBlankRegions(rectBB, blankRegions);
 
 	// find all tiles that crosssect the area, find it and sieve those unfit
 	std::vector<Tile *> tilesinPetriDish;	
 	std::unordered_map<Rectilinear *, std::vector<Tile *>> invlovedTiles;
 	fp->cs->enumerateDirectedArea(rectBB, tilesinPetriDish);
 	for(Tile *const &t : tilesinPetriDish){
-		Rectilinear *tilesRectilinear = fp->blockTilePayload[t];
-		Rectangle tileRectangle = t->getRectangle();
-		blankDPS -= tileRectangle;
+		Rectilinear *tilesRectilinear = t->getBlockPayload();
 		if(tilesRectilinear->getType() == rectilinearType::PREPLACED) continue;
 		if(tilesRectilinear == rect) continue;
 
@@ -1508,12 +1513,12 @@ std::unordered_map<Rectilinear *, DoughnutPolygonSet> &affectedNeighbors) const{
 		involvedRectilinears.push_back(it->first);
 	}
 
-	// start filling the candidates to grow	
-	std::vector<DoughnutPolygon> growCandidates;
+	// start filling the candidates to grow, each candidate is kept as disjoint rectangles
+	std::vector<std::vector<Rectangle>> growCandidates;
 	std::vector<Rectilinear *> growCandidatesRectilinear;
 	// start with the blank tiles (they have urgency 0)	
-	for(int i = 0; i < blankDPS.size(); ++i){
-		growCandidates.push_back(blankDPS[i]);
+	for(std::vector<Rectangle> &blankRegion : blankRegions){
+		growCandidates.push_back(std::move(blankRegion));
 		growCandidatesRectilinear.push_back(nullptr);
 	}
 	// then those Rectiliears
@@ -1525,14 +1530,14 @@ std::unordered_map<Rectilinear *, DoughnutPolygonSet> &affectedNeighbors) const{
 		}
 		// trim those are out out of the bounding box
 		rectDPS &= rectBB;
-		int rectDPSSize = rectDPS.size();
-		for(int j = 0; j < rectDPSSize; ++j){
-			growCandidates.push_back(rectDPS[j]);
-			growCandidatesRectilinear.push_back(tgRect);
-		}
 		// put the larger block at first place
-		std::sort(growCandidates.end() - rectDPSSize, growCandidates.end(), 
+		std::sort(rectDPS.begin(), rectDPS.end(), 
 			[&](DoughnutPolygon a, DoughnutPolygon b){return boost::polygon::size(a) > boost::polygon::size(b);});
+		for(DoughnutPolygon const &rectDP : rectDPS){
+			growCandidates.push_back({});
+			dps::diceIntoRectangles(DoughnutPolygonSet(1, rectDP), growCandidates.back());
+			growCandidatesRectilinear.push_back(tgRect);
+		}
 		
 	}	
 	int growCandidateSize = growCandidates.size();
@@ -1561,22 +1566,22 @@ std::unordered_map<Rectilinear *, DoughnutPolygonSet> &affectedNeighbors) const{
 		for(int i = 0; i < growCandidateSize; ++i){
 			if(growCandidateSelect[i]) continue;
 
-			DoughnutPolygon markedDP = growCandidates[i];
+			const std::vector<Rectangle> &markedRectangles = growCandidates[i];
 			// test if installing this marked part would turn the current shape strange
 
 			DoughnutPolygonSet xSelfDPS(currentRectDPS);
-			xSelfDPS += markedDP;
+			xSelfDPS += markedRectangles;
 			if(!(dps::oneShape(xSelfDPS) && dps::noHole(xSelfDPS))){
-				// intrducing the markedDP would cause dpSet to generate strange shape, give up on the tile
+				// intrducing the markedRectangles would cause dpSet to generate strange shape, give up on the tile
 				continue;
 			}
 
-			// test if pulling off the marked part would harm the victim too bad, skip if markedDP belongs to blank
+			// test if pulling off the marked part would harm the victim too bad, skip if markedRectangles belongs to blank
 			Rectilinear *victimRect = growCandidatesRectilinear[i];
 			if(victimRect != nullptr){
-				// markedDP belongs to other Rectilinear
+				// markedRectangles belongs to other Rectilinear
 				DoughnutPolygonSet xVictimDPS(affectedNeighbors[victimRect]);
-				xVictimDPS -= markedDP;
+				xVictimDPS -= markedRectangles;
 
 				// if removing the piece makes the victim rectilinear illegal, quit	
 				if(!dps::checkIsLegal(xVictimDPS, victimRect->getLegalArea(), fp->getGlobalAspectRatioMin(), 
@@ -1605,11 +1610,11 @@ std::unordered_map<Rectilinear *, DoughnutPolygonSet> &affectedNeighbors) const{
 			growCandidateSelect[i] = true;
 			keepGrowing = true;
 			hasGrow = true;
-			currentRectDPS += markedDP;
+			currentRectDPS += markedRectangles;
 			DoughnutPolygonSet markedDPS;
-			markedDPS += markedDP;
-			if(victimRect != nullptr){ // markedDP belongs to other Rectilienar
-				affectedNeighbors[victimRect] -= markedDP;
+			markedDPS += markedRectangles;
+			if(victimRect != nullptr){ // markedRectangles belongs to other Rectilienar
+				affectedNeighbors[victimRect] -= markedRectangles;
 			}
 		}
 	}
@@ -1974,18 +1979,18 @@ bool RefineEngine::executeRefineTrimming(Rectilinear *rect, direction2D directio
 bool RefineEngine::trialGrow(DoughnutPolygonSet &dpSet, Rectilinear *dpSetRect ,Rectangle &growArea, std::unordered_map<Rectilinear *, DoughnutPolygonSet> &affectedNeighbor) const {
 	using namespace boost::polygon::operators;
 
-	DoughnutPolygonSet petriDishDPS, blankDPS;
+	DoughnutPolygonSet petriDishDPS;
 	petriDishDPS += growArea;
-	blankDPS += growArea;
+	// the white space inside the area comes straight from the blank tiles, one region per connected piece
+	std::vector<std::vector<Rectangle>> blankRegions;
+	fp->cs->collectBlankRegions(growArea, blankRegions);
 
 	// find all tiles that crosssect the area, find it and sieve those unfit
 	std::vector<Tile *> tilesinPetriDish;	
 	std::unordered_map<Rectilinear *, std::vector<Tile *>> invlovedTiles;
 	fp->cs->enumerateDirectedArea(growArea, tilesinPetriDish);
 	for(Tile *const &t : tilesinPetriDish){
-		Rectilinear *tilesRectilinear = fp->blockTilePayload[t];
-		Rectangle tileRectangle = t->getRectangle();
-		blankDPS -= tileRectangle;
+		Rectilinear *tilesRectilinear = t->getBlockPayload();
 		if(tilesRectilinear->getType() == rectilinearType::PREPLACED) continue;
 
 		std::unordered_map<Rectilinear *, std::vector<Tile *>>::iterator it = invlovedTiles.find(tilesRectilinear);
@@ -2004,12 +2009,12 @@ bool RefineEngine::trialGrow(DoughnutPolygonSet &dpSet, Rectilinear *dpSetRect ,
 	std::sort(involvedRectilinears.begin(), involvedRectilinears.end(), 
 		[&](Rectilinear *A, Rectilinear *B) {return this->rectConnWeightSum.at(A) < rectConnWeightSum.at(B);});
 
-	// start filling the candidates to grow	
-	std::vector<DoughnutPolygon> growCandidates;
+	// start filling the candidates to grow, each candidate is kept as disjoint rectangles
+	std::vector<std::vector<Rectangle>> growCandidates;
 	std::vector<Rectilinear *> growCandidatesRectilinear;
 	// start with the blank tiles (they have urgency 0)	
-	for(int i = 0; i < blankDPS.size(); ++i){
-		growCandidates.push_back(blankDPS[i]);
+	for(std::vector<Rectangle> &blankRegion : blankRegions){
+		growCandidates.push_back(std::move(blankRegion));
 		growCandidatesRectilinear.push_back(nullptr);
 	}
 	// then those Rectiliears
@@ -2021,14 +2026,14 @@ bool RefineEngine::trialGrow(DoughnutPolygonSet &dpSet, Rectilinear *dpSetRect ,
 		}
 		// trim those are out out of the bounding box
 		rectDPS &= growArea;
-		int rectDPSSize = rectDPS.size();
-		for(int j = 0; j < rectDPSSize; ++j){
-			growCandidates.push_back(rectDPS[j]);
-			growCandidatesRectilinear.push_back(tgRect);
-		}
 		// put the larger block at first place
-		std::sort(growCandidates.end() - rectDPSSize, growCandidates.end(), 
+		std::sort(rectDPS.begin(), rectDPS.end(), 
 			[&](DoughnutPolygon a, DoughnutPolygon b){return boost::polygon::size(a) > boost::polygon::size(b);});
+		for(DoughnutPolygon const &rectDP : rectDPS){
+			growCandidates.push_back({});
+			dps::diceIntoRectangles(DoughnutPolygonSet(1, rectDP), growCandidates.back());
+			growCandidatesRectilinear.push_back(tgRect);
+		}
 		
 	}	
 	
@@ -2059,22 +2064,22 @@ bool RefineEngine::trialGrow(DoughnutPolygonSet &dpSet, Rectilinear *dpSetRect ,
 		for(int i = 0; i < growCandidateSize; ++i){
 			if(growCandidateSelect[i]) continue;
 
-			DoughnutPolygon markedDP = growCandidates[i];
+			const std::vector<Rectangle> &markedRectangles = growCandidates[i];
 			// test if installing this marked part would turn the current shape strange
 
 			DoughnutPolygonSet xSelfDPS(dpSet);
-			xSelfDPS += markedDP;
+			xSelfDPS += markedRectangles;
 			if(!(dps::oneShape(xSelfDPS) && dps::noHole(xSelfDPS) && dps::innerWidthLegal(xSelfDPS))){
-				// intrducing the markedDP would cause dpSet to generate strange shape, give up on the tile
+				// intrducing the markedRectangles would cause dpSet to generate strange shape, give up on the tile
 				continue;
 			}
 
-			// test if pulling off the marked part would harm the victim too bad, skip if markedDP belongs to blank
+			// test if pulling off the marked part would harm the victim too bad, skip if markedRectangles belongs to blank
 			Rectilinear *victimRect = growCandidatesRectilinear[i];
 			if(victimRect != nullptr){
 
 				DoughnutPolygonSet xVictimDPS(affectedNeighbor[victimRect]);
-				xVictimDPS -= markedDP;
+				xVictimDPS -= markedRectangles;
 
 				if(!dps::checkIsLegal(xVictimDPS, victimRect->getLegalArea(), fp->getGlobalAspectRatioMin(), 
 					fp->getGlobalAspectRatioMax(), fp->getGlobalUtilizationMin())){
@@ -2101,11 +2106,11 @@ bool RefineEngine::trialGrow(DoughnutPolygonSet &dpSet, Rectilinear *dpSetRect ,
 			growCandidateSelect[i] = true;
 			keepGrowing = true;
 			hasGrow = true;
-			dpSet += markedDP;
+			dpSet += markedRectangles;
 			DoughnutPolygonSet markedDPS;
-			markedDPS += markedDP;
-			if(victimRect != nullptr){ // markedDP belongs to other Rectilienar
-				affectedNeighbor[victimRect] -= markedDP;
+			markedDPS += markedRectangles;
+			if(victimRect != nullptr){ // markedRectangles belongs to other Rectilienar
+				affectedNeighbor[victimRect] -= markedRectangles;
 			}
 		}
 	}
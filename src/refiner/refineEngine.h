@@ -21,9 +21,14 @@ private:
     bool REFINE_USE_GRADIENT_SHRINK = true;
 
 public:
+    // the floorplan being refined: a private copy of floorplan if keepOriginal (floorplan itself is never modified, needed when
+    // several engines start from the same floorplan), otherwise floorplan itself, refined in place without paying for a copy
     Floorplan *fp;
-    RefineEngine(Floorplan *floorplan, int maxIter, bool useGradientOrder, len_t initMomentum, double momentumGrowth, bool growGradient, bool shrinkGradient);
+    RefineEngine(Floorplan *floorplan, int maxIter, bool useGradientOrder, len_t initMomentum, double momentumGrowth, bool growGradient, bool shrinkGradient,
+                bool keepOriginal);
 
+    // refine fp and return it at its best HPWL state, the caller owns the returned floorplan (the same object it passed in unless keepOriginal).
+    // Tile pointers into fp taken before refine() are invalid afterwards, see Floorplan::restoreSnapshot()
     Floorplan *refine();
     bool refineRectilinear(Rectilinear *rect) const;
     